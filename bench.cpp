@@ -0,0 +1,358 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <random>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <mpi.h>
+
+
+#include "src/map_info.h"
+#include "src/instance_io.h"
+#include "src/solver.h"
+#include "src/batch_runner.h"
+
+
+using namespace std;
+
+// Runs instances several times in one MPI job and checks prices against the expected results.
+// Every rank takes part in every run, counters are summed over ranks, peak RSS is the largest one.
+// Instances missing from the expected prices are run but reported as unchecked, not as passes.
+//
+// bench [solver options] [--repeat=N] [--data=DIR] [--expected=FILE] [--format=csv|json]
+//       [--output=FILE] [--verbose] [instance files...]
+// bench --parse=SIZE [--repeat=N] -- instance loading instead, on a generated SIZE x SIZE board
+
+#define PRICE_UNKNOWN INT32_MIN
+
+struct BenchRun {
+    string instance;
+    int run;
+    string engine;
+    int price;
+    int expected;
+    long long nodes;  // search nodes, states for profile dp
+    long long prunes;
+    double wall;      // seconds on rank 0
+    double cpu;       // seconds of all threads of all ranks
+    long peakRss;     // kB, largest rank, high water mark of this run
+
+    bool checked() const {
+        return expected != PRICE_UNKNOWN;
+    }
+
+    bool ok() const {
+        return !checked() || price == expected;
+    }
+
+    double nodesPerSecond() const {
+        return wall > 0 ? (double) nodes / wall : 0;
+    }
+
+    double pruneRatio() const {
+        return nodes > 0 ? (double) prunes / (double) nodes : 0;
+    }
+};
+
+// "instance,price" lines, # starts a comment. A price that is no number is reported in error
+map<string, int> loadExpected(const string &file, string &error) {
+    map<string, int> expected;
+    ifstream is(file);
+    string line;
+    for (int number = 1; getline(is, line); number++) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        size_t comma = line.find(',');
+        if (comma == string::npos)
+            continue;
+        try {
+            expected[line.substr(0, comma)] = stoi(line.substr(comma + 1));
+        } catch (const logic_error &) {
+            error = file + ": line " + to_string(number) + ": price is no number";
+            return expected;
+        }
+    }
+    return expected;
+}
+
+double cpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+           + (double) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// VmHWM is reset by writing 5 to clear_refs, so every run gets its own peak. Without procfs the
+// peak falls back to the one of the whole process life
+void resetPeakRss() {
+    ofstream os("/proc/self/clear_refs");
+    if (os)
+        os << "5";
+}
+
+long peakRssKb() {
+    ifstream is("/proc/self/status");
+    string line;
+    while (getline(is, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return stol(line.substr(6));
+    }
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void runOnce(MapInfo *info, const SolverConfig &config, const int &rank, const bool &verbose, BenchRun &result) {
+    // solvers log every message, keep the report readable
+    streambuf *log = cout.rdbuf();
+    if (!verbose)
+        cout.rdbuf(nullptr);
+
+    long long counters[2] = {0, 0};
+    resetPeakRss();
+    MPI_Barrier(MPI_COMM_WORLD);
+    double wallStart = MPI_Wtime();
+    double cpuStart = cpuSeconds();
+
+    // profile dp whose states do not fit leaves the board to branch and bound, its time counts
+    bool dp = useProfileDp(*info, config);
+    if (dp) {
+        SolverResult solved(ArrayMap(info->rows, info->columns, info->banned));
+        size_t states = 0;
+        dp = solveProfileDp(info, config, solved, states);
+        result.engine = "dp";
+        result.price = solved.price;
+        counters[0] = (long long) states;
+    }
+    if (!dp) {
+        result.engine = "bnb";
+        Solver solver(info, config);
+        solver.solve();
+        if (rank == 0)
+            result.price = solver.best->price;
+        counters[0] = solver.stats.nodes;
+        counters[1] = solver.stats.prunes;
+    }
+
+    result.wall = MPI_Wtime() - wallStart;
+    double cpu = cpuSeconds() - cpuStart;
+    long rss = peakRssKb();
+
+    cout.rdbuf(log);
+    cout.clear();
+
+    long long total[2];
+    MPI_Reduce(counters, total, 2, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&cpu, &result.cpu, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&rss, &result.peakRss, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    result.nodes = total[0];
+    result.prunes = total[1];
+}
+
+void printCsv(ostream &os, const vector<BenchRun> &runs) {
+    os << "instance,run,engine,price,expected,ok,nodes,prunes,nodes_per_s,prune_ratio,wall_s,cpu_s,peak_rss_kb" << endl;
+    for (const BenchRun &run : runs) {
+        os << run.instance << "," << run.run << "," << run.engine << "," << run.price << ",";
+        if (run.checked())
+            os << run.expected;
+        os << ",";
+        if (run.checked())
+            os << (run.ok() ? 1 : 0);
+        os << "," << run.nodes << "," << run.prunes << ","
+           << (long long) run.nodesPerSecond() << "," << run.pruneRatio() << ","
+           << run.wall << "," << run.cpu << "," << run.peakRss << endl;
+    }
+}
+
+void printJson(ostream &os, const vector<BenchRun> &runs) {
+    os << "[" << endl;
+    for (size_t i = 0; i < runs.size(); i++) {
+        const BenchRun &run = runs[i];
+        os << "  {\"instance\": \"" << run.instance << "\", \"run\": " << run.run
+           << ", \"engine\": \"" << run.engine << "\", \"price\": " << run.price << ", \"expected\": ";
+        if (run.checked())
+            os << run.expected;
+        else
+            os << "null";
+        os << ", \"ok\": " << (!run.checked() ? "null" : run.ok() ? "true" : "false") << ", \"nodes\": " << run.nodes
+           << ", \"prunes\": " << run.prunes << ", \"nodes_per_s\": " << (long long) run.nodesPerSecond()
+           << ", \"prune_ratio\": " << run.pruneRatio() << ", \"wall_s\": " << run.wall
+           << ", \"cpu_s\": " << run.cpu << ", \"peak_rss_kb\": " << run.peakRss << "}"
+           << (i + 1 < runs.size() ? "," : "") << endl;
+    }
+    os << "]" << endl;
+}
+
+// loads of a generated board with a tenth of the cells banned -- text read through a stream, text and
+// binary memory mapped. Runs on one rank
+void parseBench(const int &size, const int &repeat, ostream &os) {
+    mt19937 random(1);
+    vector<uint64_t> cells(MapInfo::bitmapWords(size * size), 0);
+    int k = 0;
+    for (size_t cell = 0; cell < (size_t) (size * size); cell++) {
+        if (random() % 10 == 0) {
+            cells[cell / 64] |= 1ULL << (cell % 64);
+            k++;
+        }
+    }
+    MapInfo info(size, size, 3, 5, 1, 3, -2, k);
+    info.setBanned(cells);
+
+    string base = "/tmp/mi_pdp_parse_" + to_string(getpid());
+    saveInstance(base + ".txt", info, false);
+    saveInstance(base + ".bin", info, true);
+
+    os << "format,bytes,banned,ms_per_load,mb_per_s" << endl;
+    const char *formats[3] = {"text-stream", "text-mmap", "binary-mmap"};
+    for (int format = 0; format < 3; format++) {
+        string file = base + (format == 2 ? ".bin" : ".txt");
+        struct stat status;
+        stat(file.c_str(), &status);
+        double start = MPI_Wtime();
+        for (int run = 0; run < repeat; run++) {
+            string error;
+            MapInfo *loaded;
+            if (format == 0) {
+                ifstream is(file);
+                loaded = load(is, error);
+            } else {
+                loaded = loadInstance(file, error);
+            }
+            if (!loaded || (run == 0 && loaded->banned != info.banned))
+                cerr << formats[format] << " load differs from the board: " << error << endl;
+            delete loaded;
+        }
+        double seconds = (MPI_Wtime() - start) / repeat;
+        os << formats[format] << "," << status.st_size << "," << k << "," << seconds * 1000 << ","
+           << (double) status.st_size / seconds / 1e6 << endl;
+    }
+    remove((base + ".txt").c_str());
+    remove((base + ".bin").c_str());
+}
+
+int main(int argc, char **argv) {
+    // threads of the master search while its main thread serves the workers
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    SolverConfig config;
+    int repeat = 3;
+    string dataDir = "data";
+    string expectedFile;
+    string format = "csv";
+    string output;
+    bool verbose = false;
+    int parseSize = 0;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (parseOption(arg, config))
+                continue;
+            if (arg.compare(0, 9, "--repeat=") == 0)
+                repeat = stoi(arg.substr(9));
+            else if (arg.compare(0, 7, "--data=") == 0)
+                dataDir = arg.substr(7);
+            else if (arg.compare(0, 11, "--expected=") == 0)
+                expectedFile = arg.substr(11);
+            else if (arg.compare(0, 9, "--format=") == 0)
+                format = arg.substr(9);
+            else if (arg.compare(0, 9, "--output=") == 0)
+                output = arg.substr(9);
+            else if (arg == "--verbose")
+                verbose = true;
+            else if (arg.compare(0, 8, "--parse=") == 0)
+                parseSize = stoi(arg.substr(8));
+            else
+                files.push_back(arg);
+        } catch (const logic_error &) {
+            // every rank parses the same arguments and leaves here together
+            if (rank == 0)
+                cerr << "option " << arg << ": value is no number" << endl;
+            MPI_Finalize();
+            return 2;
+        }
+    }
+    if (parseSize > 0) {
+        if (rank == 0)
+            parseBench(parseSize, repeat, cout);
+        MPI_Finalize();
+        return 0;
+    }
+    if (files.empty())
+        files = listInstances(dataDir);
+    if (expectedFile.empty())
+        expectedFile = dataDir + "/expected.csv";
+    string expectedError;
+    map<string, int> expected = loadExpected(expectedFile, expectedError);
+    if (!expectedError.empty()) {
+        if (rank == 0)
+            cerr << expectedError << endl;
+        MPI_Finalize();
+        return 2;
+    }
+
+    vector<BenchRun> runs;
+    vector<string> unchecked;
+    bool ok = true;
+    for (const string &file : files) {
+        string error;
+        MapInfo *mapInfo = loadInstance(file, error);
+        if (!mapInfo) {
+            if (rank == 0)
+                cerr << error << endl;
+            ok = false;
+            continue;
+        }
+        string name = instanceName(file);
+
+        for (int run = 0; run < repeat; run++) {
+            BenchRun result = {name, run, "", PRICE_UNKNOWN, PRICE_UNKNOWN, 0, 0, 0, 0, 0};
+            auto found = expected.find(name);
+            if (found != expected.end())
+                result.expected = found->second;
+
+            runOnce(mapInfo, config, rank, verbose, result);
+            if (rank == 0) {
+                cerr << name << " run " << run << ": price " << result.price << ", " << result.wall << " s"
+                     << (!result.checked() ? " -- NOT CHECKED" : result.ok() ? "" : " -- WRONG PRICE") << endl;
+                ok = ok && result.ok();
+                runs.push_back(result);
+            }
+        }
+        if (expected.find(name) == expected.end())
+            unchecked.push_back(name);
+        delete mapInfo;
+    }
+
+    if (rank == 0 && !unchecked.empty()) {
+        cerr << unchecked.size() << " instances not in " << expectedFile << ", prices unchecked:";
+        for (const string &name : unchecked)
+            cerr << " " << name;
+        cerr << endl;
+    }
+
+    if (rank == 0) {
+        ofstream ofile;
+        if (!output.empty())
+            ofile.open(output);
+        ostream &os = output.empty() ? cout : ofile;
+        if (format == "json")
+            printJson(os, runs);
+        else
+            printCsv(os, runs);
+    }
+
+    MPI_Finalize();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+#include "src/map_info.h"
+#include "src/instance_io.h"
+
+
+using namespace std;
+
+// Converts instances between the text and the binary format, reading either one.
+//
+// convert [--to=text|binary] input output
+//
+// Without --to the output gets the format the input does not have.
+
+int main(int argc, char **argv) {
+    string to;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 5, "--to=") == 0)
+            to = arg.substr(5);
+        else
+            files.push_back(arg);
+    }
+    if (files.size() != 2 || (!to.empty() && to != "text" && to != "binary")) {
+        cerr << "usage: " << argv[0] << " [--to=text|binary] input output" << endl;
+        return 2;
+    }
+
+    string error;
+    MapInfo *info = loadInstance(files[0], error);
+    if (!info) {
+        cerr << error << endl;
+        return 1;
+    }
+    bool binary = to.empty() ? !isBinaryInstanceFile(files[0]) : to == "binary";
+    bool ok = saveInstance(files[1], *info, binary);
+    if (!ok)
+        cerr << files[1] << ": cannot write" << endl;
+    delete info;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <mpi.h>
+
+
+#include "src/map_info.h"
+#include "src/instance_io.h"
+#include "src/instance_generator.h"
+#include "src/brute_force.h"
+#include "src/solver.h"
+#include "src/region_solver.h"
+
+
+using namespace std;
+
+// Makes instances, or checks the solvers on many small ones against BruteForceSolver.
+//
+// generate [--rows=R] [--columns=C] [--density=D] [--i1=N] [--i2=N] [--c1=N] [--c2=N] [--cn=N]
+//          [--adversarial] [--seed=S] [--count=N] [--out=DIR] [--binary]
+// generate --check=N [--max-side=N] [--seed=S] [--verbose] [solver options]
+//
+// Instances go to DIR/gen-<seed>.txt (.bin), seed counting up from --seed, or one to stdout.
+// Checks run on all ranks, Solver splits every board over them like a real run; the profile dp
+// is checked as well where the board fits it, RegionSolver where banned cells cut the board apart.
+// Exit code 1 when anything disagrees.
+
+// price the solver found and the price of its map have to match the reference
+bool checkResult(const MapInfo &info, const string &engine, const SolverResult &result, const int &expected,
+                 const int &seed) {
+    int price;
+    string error;
+    if (!BruteForceSolver::price(info, result.map, price, error)) {
+        cerr << "seed " << seed << ": " << engine << " map invalid, " << error << endl;
+        return false;
+    }
+    if (price != result.price || result.price != expected) {
+        cerr << "seed " << seed << ": " << engine << " price " << result.price << ", its map " << price
+             << ", brute force " << expected << endl;
+        return false;
+    }
+    return true;
+}
+
+int check(const int &count, const int &maxSide, const int &seed, const SolverConfig &config, const bool &verbose) {
+    int rank, procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &procs);
+    int failures = 0;
+    for (int i = 0; i < count; i++) {
+        InstanceGenerator generator((unsigned int) (seed + i));
+        MapInfo *info = generator.generateSmall(maxSide);
+
+        // solvers log every message, keep the report readable
+        streambuf *log = cout.rdbuf();
+        if (!verbose)
+            cout.rdbuf(nullptr);
+        Solver solver(info, config);
+        // master alone has no workers to search
+        if (procs == 1)
+            solver.solveLocal();
+        else
+            solver.solve();
+        // boards banned cells cut apart are checked by regions as well
+        RegionSolver regions(info, config);
+        SolverResult split(ArrayMap(info->rows, info->columns, info->banned));
+        if (regions.split())
+            split = regions.solve();
+        cout.rdbuf(log);
+        cout.clear();
+
+        if (rank == 0) {
+            BruteForceSolver reference(info);
+            int expected = reference.solve();
+            bool ok = checkResult(*info, "bnb", *solver.best, expected, seed + i);
+            if (regions.split())
+                ok = checkResult(*info, "regions", split, expected, seed + i) && ok;
+            if (ProfileSolver::profileBits(*info) <= ProfileSolver::MAX_PROFILE) {
+                ProfileSolver profile(info);
+                ok = checkResult(*info, "dp", profile.solve(), expected, seed + i) && ok;
+            }
+            if (!ok) {
+                failures++;
+                writeText(cerr, *info);
+            }
+        }
+        delete info;
+    }
+    MPI_Bcast(&failures, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+        cerr << count - failures << " of " << count << " boards agree with brute force" << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    // threads of the master search while its main thread serves the workers
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    GeneratorConfig generator;
+    SolverConfig config;
+    int seed = 1, count = 1, checks = 0, maxSide = 5;
+    string out;
+    bool binary = false, verbose = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (parseOption(arg, config))
+                continue;
+            if (arg.compare(0, 7, "--rows=") == 0)
+                generator.rows = stoi(arg.substr(7));
+            else if (arg.compare(0, 10, "--columns=") == 0)
+                generator.columns = stoi(arg.substr(10));
+            else if (arg.compare(0, 10, "--density=") == 0)
+                generator.density = stod(arg.substr(10));
+            else if (arg.compare(0, 5, "--i1=") == 0)
+                generator.i1 = stoi(arg.substr(5));
+            else if (arg.compare(0, 5, "--i2=") == 0)
+                generator.i2 = stoi(arg.substr(5));
+            else if (arg.compare(0, 5, "--c1=") == 0)
+                generator.c1 = stoi(arg.substr(5));
+            else if (arg.compare(0, 5, "--c2=") == 0)
+                generator.c2 = stoi(arg.substr(5));
+            else if (arg.compare(0, 5, "--cn=") == 0)
+                generator.cn = stoi(arg.substr(5));
+            else if (arg == "--adversarial")
+                generator.pattern = BanPattern::ADVERSARIAL;
+            else if (arg.compare(0, 7, "--seed=") == 0)
+                seed = stoi(arg.substr(7));
+            else if (arg.compare(0, 8, "--count=") == 0)
+                count = stoi(arg.substr(8));
+            else if (arg.compare(0, 6, "--out=") == 0)
+                out = arg.substr(6);
+            else if (arg == "--binary")
+                binary = true;
+            else if (arg.compare(0, 8, "--check=") == 0)
+                checks = stoi(arg.substr(8));
+            else if (arg.compare(0, 11, "--max-side=") == 0)
+                maxSide = stoi(arg.substr(11));
+            else if (arg == "--verbose")
+                verbose = true;
+            else {
+                if (rank == 0)
+                    cerr << "unknown option " << arg << endl;
+                MPI_Finalize();
+                return 2;
+            }
+        } catch (const logic_error &) {
+            // every rank parses the same arguments and leaves here together
+            if (rank == 0)
+                cerr << "option " << arg << ": value is no number" << endl;
+            MPI_Finalize();
+            return 2;
+        }
+    }
+
+    int result = 0;
+    if (checks > 0) {
+        result = check(checks, maxSide, seed, config, verbose);
+    } else if (rank == 0) {
+        // same limits as instance files, so whatever is written loads again
+        int values[8] = {generator.rows, generator.columns, generator.i1, generator.i2,
+                         generator.c1, generator.c2, generator.cn, 0};
+        string error;
+        MapInfo *checked = checkedInstance(values, error);
+        if (!checked || generator.density < 0 || generator.density > 1) {
+            cerr << (checked ? "density outside 0 .. 1" : error) << endl;
+            result = 2;
+        }
+        delete checked;
+        for (int i = 0; i < count && result == 0; i++) {
+            InstanceGenerator instances((unsigned int) (seed + i));
+            MapInfo *info = instances.generate(generator);
+            if (out.empty()) {
+                writeText(cout, *info);
+            } else {
+                string file = out + "/gen-" + to_string(seed + i) + (binary ? ".bin" : ".txt");
+                if (!saveInstance(file, *info, binary)) {
+                    cerr << file << ": cannot write" << endl;
+                    result = 1;
+                }
+            }
+            delete info;
+        }
+    }
+
+    MPI_Finalize();
+    return result;
+}
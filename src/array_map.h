@@ -1,5 +1,6 @@
 #include <iostream>
-#include <set>
+#include <vector>
+#include <algorithm>
 
 #ifndef MI_PDP_ARRAY_MAP_H
 #define MI_PDP_ARRAY_MAP_H
@@ -7,8 +8,34 @@
 #define BLOCK_FREE 0
 #define BLOCK_BAN -1
 
+// shape() of a cell -- covered flag and the neighbours that belong to the same tile.
+// Banned cells are covered with no neighbours, free ones are 0
+#define LINK_RIGHT 1
+#define LINK_DOWN 2
+#define LINK_LEFT 4
+#define LINK_UP 8
+#define CELL_COVERED 16
+
 using namespace std;
 
+// placed tile, holds everything needed to take the placement back
+struct Move {
+    int x, y;
+    int tile;
+    bool vertical;
+
+    // one int on the wire -- 12 bits x, 12 bits y, 7 bits tile, vertical flag on top
+    int pack() const {
+        return (int) ((unsigned int) x | (unsigned int) y << 12 | (unsigned int) tile << 24
+                      | (unsigned int) vertical << 31);
+    }
+
+    static Move unpack(const int &packed) {
+        unsigned int bits = (unsigned int) packed;
+        return {(int) (bits & 0xFFF), (int) (bits >> 12 & 0xFFF), (int) (bits >> 24 & 0x7F), (bits >> 31) != 0};
+    }
+};
+
 class ArrayMap {
 public:
     int rows, columns;
@@ -19,7 +46,7 @@ public:
         // cout << "DEFAULT CONSTRUCTOR ARRAY_MAP " << endl;
     }
 
-    ArrayMap(const int rows, const int columns, const set<pair<int,int>> & banned)
+    ArrayMap(const int rows, const int columns, const vector<pair<int,int>> & banned)
             : rows(rows), columns(columns), nextId(1), x(0), y(0) {
         int n = rows * columns;
         this->matrix = new int[n];
@@ -30,32 +57,55 @@ public:
             setValue(ban.first, ban.second, BLOCK_BAN);
     }
 
-    ArrayMap(int * map, const int & rows, const int & columns, const int & nextId, const int & x, const int & y)
-    :rows(rows), columns(columns), nextId(nextId), x(x), y(y){
-        int n = rows * columns;
-        matrix = new int[n];
-        for(int i = 0; i < n; i++)
-            matrix[i] = map[i];
+    // packed map is x, y, tile count and Move::pack() of every tile in the order of ids.
+    // Banned cells stay out, every rank has them in MapInfo
+    static int packedSize(const int &maxTiles) {
+        return 3 + maxTiles;
     }
 
+    // ints taken by the packed map starting at buffer
+    static int packedLength(const int *buffer) {
+        return packedSize(buffer[2]);
+    }
 
-    pair<int, int*> serialize(){
-        // MAP SIZE + x + y + nextId + rows + columns
-        int n = this->rows * this->columns;
-        int size = serialize_size();
-        int * buffer = new int[size];
-
-        for(int i = 0; i < n;i++)
-            buffer[i] = matrix[i];
-        buffer[n] = nextId;
-        buffer[n+1] = x;
-        buffer[n+2] = y;
-
-        return make_pair(size, buffer);
+    int pack(int *buffer) const {
+        buffer[0] = x;
+        buffer[1] = y;
+        buffer[2] = nextId - 1;
+        for (int iy = 0; iy < rows; iy++) {
+            for (int ix = 0; ix < columns; ix++) {
+                // ids go 1 .. nextId - 1 in placement order, tile is found by its top left cell
+                int id = getValue(ix, iy);
+                if (id <= 0 || (ix > 0 && getValue(ix - 1, iy) == id) || (iy > 0 && getValue(ix, iy - 1) == id))
+                    continue;
+
+                bool vertical = iy + 1 < rows && getValue(ix, iy + 1) == id;
+                int tile = 1;
+                while (vertical ? iy + tile < rows && getValue(ix, iy + tile) == id
+                                : ix + tile < columns && getValue(ix + tile, iy) == id)
+                    tile++;
+                buffer[2 + id] = Move{ix, iy, tile, vertical}.pack();
+            }
+        }
+        return packedSize(nextId - 1);
     }
 
-    int serialize_size(){
-        return this->rows * this->columns + 3;
+    // replay packed tiles on top of start, the map with banned cells only
+    int unpack(const int *buffer, const ArrayMap &start) {
+        *this = start;
+        int tiles = buffer[2];
+        for (int i = 0; i < tiles; i++) {
+            Move move = Move::unpack(buffer[3 + i]);
+            x = move.x;
+            y = move.y;
+            if (move.vertical)
+                placeVerticalInPlace(move.tile);
+            else
+                placeHorizontalInPlace(move.tile);
+        }
+        x = buffer[0];
+        y = buffer[1];
+        return packedSize(tiles);
     }
 
     void writeCopy(const ArrayMap &copy) {
@@ -86,8 +136,17 @@ public:
     ArrayMap &operator=(const ArrayMap &copy) {
         if (this == &copy)
             return *this;
-        delete[] matrix;
 
+        // same board -- keep the cells, no reallocation
+        if (matrix && rows == copy.rows && columns == copy.columns) {
+            nextId = copy.nextId;
+            x = copy.x;
+            y = copy.y;
+            copy_n(copy.matrix, rows * columns, matrix);
+            return *this;
+        }
+
+        delete[] matrix;
         writeCopy(copy);
         return *this;
     }
@@ -126,6 +185,18 @@ public:
         //  return matrix[x][y];
     }
 
+    int shape(const int &x, const int &y) const {
+        int id = getValue(x, y);
+        if (id == BLOCK_FREE)
+            return 0;
+        if (id == BLOCK_BAN)
+            return CELL_COVERED;
+        return CELL_COVERED | (x + 1 < columns && getValue(x + 1, y) == id ? LINK_RIGHT : 0)
+               | (y + 1 < rows && getValue(x, y + 1) == id ? LINK_DOWN : 0)
+               | (x > 0 && getValue(x - 1, y) == id ? LINK_LEFT : 0)
+               | (y > 0 && getValue(x, y - 1) == id ? LINK_UP : 0);
+    }
+
     void setValue(const int &x, const int &y, const int value) {
         //   assert(x < columns);
         //   assert(y < rows);
@@ -134,6 +205,9 @@ public:
     }
 
     void nextFree() {
+        // stays on the last cell like BitMap::nextFree(), there is nothing after it
+        if (isOnRightBottomCorner())
+            return;
         pair<int, int> next = nextCoordinates(x, y);
 
         while (!freeBlock(next.first, next.second) && !isOnRightBottomCorner(next.first, next.second)) {
@@ -162,7 +236,7 @@ public:
 
     }
 
-    bool canPlaceHorizontal(const int &tile) {
+    bool canPlaceHorizontal(const int &tile) const {
         if (x + tile - 1 >= columns)
             return false;
 
@@ -173,7 +247,7 @@ public:
         return true;
     }
 
-    bool canPlaceVertical(const int &tile) {
+    bool canPlaceVertical(const int &tile) const {
         if (y + tile - 1 >= rows)
             return false;
 
@@ -202,6 +276,50 @@ public:
         return map;
     }
 
+    // in place variants -- mutate this map and return record for undo()
+    Move placeHorizontalInPlace(const int &tile) {
+        Move move = {x, y, tile, false};
+        for (int i = x; i < x + tile; i++)
+            setValue(i, y, nextId);
+        nextId++;
+        nextFree();
+        return move;
+    }
+
+    Move placeVerticalInPlace(const int &tile) {
+        Move move = {x, y, tile, true};
+        for (int i = y; i < y + tile; i++)
+            setValue(x, i, nextId);
+        nextId++;
+        nextFree();
+        return move;
+    }
+
+    // place tiles of moves[0, count) in order, the same way the search did
+    void replay(const vector<Move> &moves, const size_t &count) {
+        for (size_t i = 0; i < count; i++) {
+            x = moves[i].x;
+            y = moves[i].y;
+            if (moves[i].vertical)
+                placeVerticalInPlace(moves[i].tile);
+            else
+                placeHorizontalInPlace(moves[i].tile);
+        }
+    }
+
+    void undo(const Move &move) {
+        if (move.vertical) {
+            for (int i = move.y; i < move.y + move.tile; i++)
+                setValue(move.x, i, BLOCK_FREE);
+        } else {
+            for (int i = move.x; i < move.x + move.tile; i++)
+                setValue(i, move.y, BLOCK_FREE);
+        }
+        nextId--;
+        x = move.x;
+        y = move.y;
+    }
+
     friend ostream &operator<<(ostream &os, const ArrayMap &map);
 
 private:
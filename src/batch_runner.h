@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <mpi.h>
+
+#include "instance_io.h"
+#include "map_info.h"
+#include "profile_solver.h"
+#include "solver.h"
+#include "subtree_estimator.h"
+
+#ifndef MI_PDP_BATCH_RUNNER_H
+#define MI_PDP_BATCH_RUNNER_H
+
+using namespace std;
+
+// tags of the batch, never in flight while a Solver runs
+#define TAG_BATCH_JOB 20    // master to worker, index of the instance to solve alone
+#define TAG_BATCH_RESULT 21 // worker to master, result line of the instance
+#define TAG_BATCH_END 22    // master to worker, no more small instances
+
+// instances with more estimated search nodes are split over all ranks
+#define BATCH_SPLIT_NODES 2000000
+
+// *.txt files of a directory, sorted
+inline vector<string> listInstances(const string &dir) {
+    vector<string> files;
+    DIR *handle = opendir(dir.c_str());
+    if (!handle)
+        return files;
+
+    while (dirent *entry = readdir(handle)) {
+        string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+            files.push_back(dir + "/" + name);
+    }
+    closedir(handle);
+    sort(files.begin(), files.end());
+    return files;
+}
+
+// file name without directory and .txt
+inline string instanceName(const string &file) {
+    size_t slash = file.find_last_of('/');
+    string name = slash == string::npos ? file : file.substr(slash + 1);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+        name.erase(name.size() - 4);
+    return name;
+}
+
+// Many instances in one MPI job, so MPI_Init, process start and the pool are paid once.
+// Source is a directory of *.txt instances or a manifest with one file per line, # starts a comment.
+//
+// Rank 0 sorts the instances by the estimated size of their search tree. Small ones go whole to
+// workers, one at a time to whoever is free, each solves it alone with its threads. Large ones
+// follow, each split over all ranks by the usual distributed Solver. Every instance gives one line
+// of JSON on rank 0, in the order they finish.
+class BatchRunner {
+public:
+    BatchRunner(const SolverConfig &config, ostream &out, const double &splitNodes = BATCH_SPLIT_NODES,
+                const bool &verbose = false)
+            : config(config), out(out), splitNodes(splitNodes), verbose(verbose), rank(0), procs(1) {
+    }
+
+    // false when some instance could not be solved, all ranks must call it
+    bool run(const string &source) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &procs);
+        files = readSource(source);
+        ok = true;
+
+        vector<int> small, large;
+        if (rank == 0) {
+            classify(small, large);
+            cerr << "batch: " << files.size() << " instances, " << small.size() << " solved whole, "
+                 << large.size() << " split over " << procs << " ranks" << endl;
+        }
+        if (procs == 1) {
+            // nobody to split with
+            for (const int &index : small)
+                out << solveWhole(index) << endl;
+            for (const int &index : large)
+                out << solveWhole(index) << endl;
+            return ok;
+        }
+
+        if (rank == 0)
+            dispatch(small);
+        else
+            work();
+
+        // large ones one after another on all ranks, -1 ends
+        size_t next = 0;
+        while (true) {
+            int index = rank == 0 && next < large.size() ? large[next++] : -1;
+            MPI_Bcast(&index, 1, MPI_INT, 0, MPI_COMM_WORLD);
+            if (index < 0)
+                break;
+            string line = solveSplit(index);
+            if (rank == 0)
+                out << line << endl;
+        }
+        MPI_Bcast(&ok, 1, MPI_CXX_BOOL, 0, MPI_COMM_WORLD);
+        return ok;
+    }
+
+private:
+    SolverConfig config;
+    ostream &out;
+    double splitNodes;
+    bool verbose;
+    int rank, procs;
+    bool ok;
+    vector<string> files;
+
+    static vector<string> readSource(const string &source) {
+        struct stat info;
+        if (stat(source.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+            return listInstances(source);
+
+        vector<string> files;
+        ifstream is(source);
+        string line;
+        while (getline(is, line)) {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#')
+                files.push_back(line);
+        }
+        return files;
+    }
+
+    // smallest first, the pool starts on many quick ones. Instances for profile dp count as small
+    void classify(vector<int> &small, vector<int> &large) {
+        vector<pair<double, int>> sizes;
+        for (int index = 0; index < (int) files.size(); index++) {
+            string error;
+            MapInfo *info = loadInstance(files[(size_t) index], error);
+            double size = 0;
+            if (info && !useProfileDp(*info, config)) {
+                ArrayMap map(info->rows, info->columns, info->banned);
+                map.setStart();
+                SubtreeEstimator estimator(info, max(1, config.probes));
+                // search starts from the beam incumbent, walks prune against it too
+                if (config.beamWidth > 0)
+                    estimator.incumbent = BeamSearch(info, config.beamWidth).solve(map).price;
+                estimator.warmUp(map, 0, info->startUncovered);
+                size = estimator.estimate(map, 0, info->startUncovered);
+            }
+            delete info;
+            sizes.push_back(make_pair(size, index));
+        }
+        sort(sizes.begin(), sizes.end());
+        for (const auto &size : sizes)
+            (size.first > splitNodes ? large : small).push_back(size.second);
+    }
+
+    // master of the small instances, hands out the next one to whoever sent a result
+    void dispatch(const vector<int> &small) {
+        size_t next = 0;
+        int busy = 0;
+        for (int worker = 1; worker < procs; worker++) {
+            if (next < small.size()) {
+                MPI_Send(&small[next++], 1, MPI_INT, worker, TAG_BATCH_JOB, MPI_COMM_WORLD);
+                busy++;
+            }
+        }
+        while (busy > 0) {
+            MPI_Status status;
+            MPI_Probe(MPI_ANY_SOURCE, TAG_BATCH_RESULT, MPI_COMM_WORLD, &status);
+            int size;
+            MPI_Get_count(&status, MPI_CHAR, &size);
+            string line((size_t) size, ' ');
+            MPI_Recv(&line[0], size, MPI_CHAR, status.MPI_SOURCE, TAG_BATCH_RESULT, MPI_COMM_WORLD, &status);
+            out << line << endl;
+            ok = ok && line.find("\"error\"") == string::npos;
+
+            if (next < small.size()) {
+                MPI_Send(&small[next++], 1, MPI_INT, status.MPI_SOURCE, TAG_BATCH_JOB, MPI_COMM_WORLD);
+            } else {
+                busy--;
+            }
+        }
+        for (int worker = 1; worker < procs; worker++) {
+            int dummy = 1;
+            MPI_Send(&dummy, 1, MPI_INT, worker, TAG_BATCH_END, MPI_COMM_WORLD);
+        }
+    }
+
+    void work() {
+        while (true) {
+            int index;
+            MPI_Status status;
+            MPI_Recv(&index, 1, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            if (status.MPI_TAG == TAG_BATCH_END)
+                break;
+            string line = solveWhole(index);
+            MPI_Send(line.data(), (int) line.size(), MPI_CHAR, 0, TAG_BATCH_RESULT, MPI_COMM_WORLD);
+        }
+    }
+
+    string solveWhole(const int &index) {
+        string error;
+        MapInfo *info = loadInstance(files[(size_t) index], error);
+        if (!info)
+            return failure(index, error);
+
+        double start = MPI_Wtime();
+        string line;
+        mute([&]() {
+            // states that do not fit leave the board to branch and bound
+            int price = INT32_MIN;
+            if (useProfileDp(*info, config)) {
+                ProfileSolver solver(info, (size_t) max(config.dpStates, 0LL));
+                price = solver.solve().price;
+                if (price != INT32_MIN)
+                    line = report(index, "dp", price, (long long) solver.states, MPI_Wtime() - start);
+            }
+            if (price == INT32_MIN) {
+                Solver solver(info, config);
+                solver.solveLocal();
+                line = report(index, "bnb", solver.best->price, solver.stats.nodes, MPI_Wtime() - start);
+            }
+        });
+        delete info;
+        return line;
+    }
+
+    // all ranks take part, line is valid on rank 0 only
+    string solveSplit(const int &index) {
+        string error;
+        MapInfo *info = loadInstance(files[(size_t) index], error);
+        if (!info)
+            return failure(index, error);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        string line;
+        mute([&]() {
+            Solver solver(info, config);
+            solver.solve();
+            if (rank == 0)
+                line = report(index, "bnb-split", solver.best->price, solver.summary.nodes, MPI_Wtime() - start);
+        });
+        delete info;
+        return line;
+    }
+
+    // solvers log every message, keep the result stream readable
+    template<class Body>
+    void mute(const Body &body) {
+        streambuf *log = cout.rdbuf();
+        if (!verbose)
+            cout.rdbuf(nullptr);
+        body();
+        cout.rdbuf(log);
+        cout.clear();
+    }
+
+    string report(const int &index, const string &engine, const int &price, const long long &nodes,
+                  const double &wall) const {
+        ostringstream line;
+        line << "{\"instance\": \"" << instanceName(files[(size_t) index]) << "\", \"engine\": \"" << engine
+             << "\", \"price\": " << price << ", \"nodes\": " << nodes << ", \"wall_s\": " << wall
+             << ", \"rank\": " << rank << "}";
+        return line.str();
+    }
+
+    string failure(const int &index, string error) {
+        ok = false;
+        for (size_t i = error.find_first_of("\"\\"); i != string::npos; i = error.find_first_of("\"\\", i + 2))
+            error.insert(i, "\\");
+        return "{\"instance\": \"" + instanceName(files[(size_t) index]) + "\", \"error\": \"" + error + "\"}";
+    }
+};
+
+#endif //MI_PDP_BATCH_RUNNER_H
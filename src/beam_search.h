@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "array_map.h"
+#include "map_info.h"
+#include "solver_result.h"
+
+#ifndef MI_PDP_BEAM_SEARCH_H
+#define MI_PDP_BEAM_SEARCH_H
+
+using namespace std;
+
+// Heuristic for the starting incumbent -- the branch and bound tree walked cell by cell in scan
+// order, keeping only the width most promising boards whose cursor stands on each cell. Every
+// board on the way is a solution with its uncovered cells left empty, the best one is returned.
+// Width 1 is plain greedy, the cost grows linearly with width.
+class BeamSearch {
+public:
+    size_t states; // boards expanded
+
+    BeamSearch(const MapInfo *info, const int &width)
+            : states(0), info(info), width((size_t) max(1, width)) {
+    }
+
+    SolverResult solve(const ArrayMap &start) {
+        SolverResult best(start);
+        int cells = info->rows * info->columns;
+        buckets.clear();
+        buckets.resize((size_t) cells);
+        push(unique_ptr<State>(new State{start, 0, info->startUncovered}));
+
+        for (int cell = 0; cell < cells; cell++) {
+            vector<unique_ptr<State>> layer;
+            layer.swap(buckets[(size_t) cell]);
+            trim(layer);
+            for (unique_ptr<State> &state : layer)
+                expand(*state, best);
+        }
+        return best;
+    }
+
+private:
+    struct State {
+        ArrayMap map;
+        int price;
+        int uncovered;
+    };
+
+    const MapInfo *info;
+    size_t width;
+    // boards by the scan index of their cursor, all cells before it are decided
+    vector<vector<unique_ptr<State>>> buckets;
+
+    // boards are compared by the best price they could still reach
+    int promise(const State &state) const {
+        return state.price + info->getUpperPrice(state.uncovered);
+    }
+
+    void trim(vector<unique_ptr<State>> &bucket) const {
+        if (bucket.size() <= width)
+            return;
+        nth_element(bucket.begin(), bucket.begin() + (long) width, bucket.end(),
+                    [this](const unique_ptr<State> &a, const unique_ptr<State> &b) {
+                        return promise(*a) > promise(*b);
+                    });
+        bucket.resize(width);
+    }
+
+    void push(unique_ptr<State> state) {
+        vector<unique_ptr<State>> &bucket = buckets[(size_t) (state->map.y * info->columns + state->map.x)];
+        bucket.push_back(move(state));
+        // later cells fill up before their turn, keep them from growing without bound
+        if (bucket.size() >= 2 * width)
+            trim(bucket);
+    }
+
+    void place(const State &state, const bool &vertical, const int &tile, const int &price) {
+        unique_ptr<State> child(new State{state.map, state.price + price, state.uncovered - tile});
+        if (vertical)
+            child->map.placeVerticalInPlace(tile);
+        else
+            child->map.placeHorizontalInPlace(tile);
+        push(move(child));
+    }
+
+    void expand(State &state, SolverResult &best) {
+        states++;
+        int price = state.price + info->cn * state.uncovered;
+        if (price > best.price) {
+            best.map = state.map;
+            best.price = price;
+        }
+        if (state.map.isOnRightBottomCorner())
+            return;
+
+        if (!state.map.freeBlock()) {
+            state.map.nextFree();
+            push(unique_ptr<State>(new State(state)));
+            return;
+        }
+
+        if (state.map.canPlaceHorizontal(info->i2))
+            place(state, false, info->i2, info->c2);
+        if (state.map.canPlaceVertical(info->i2))
+            place(state, true, info->i2, info->c2);
+        if (state.map.canPlaceHorizontal(info->i1))
+            place(state, false, info->i1, info->c1);
+        if (state.map.canPlaceVertical(info->i1))
+            place(state, true, info->i1, info->c1);
+
+        state.map.nextFree();
+        push(unique_ptr<State>(new State{state.map, state.price + info->cn, state.uncovered - 1}));
+    }
+};
+
+#endif //MI_PDP_BEAM_SEARCH_H
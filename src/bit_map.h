@@ -0,0 +1,234 @@
+#include <cstdint>
+#include <vector>
+
+#include "array_map.h"
+
+#ifndef MI_PDP_BIT_MAP_H
+#define MI_PDP_BIT_MAP_H
+
+using namespace std;
+
+// Occupancy only board -- one bit per cell, set when cell is banned or covered.
+// Row masks answer horizontal fits and next free cell, column masks vertical fits. A row is one
+// word, so at most 64 columns; a column takes as many words as the board has rows for.
+// Tile ids are not stored, rebuild them with replay() from the list of placements. Link masks
+// keep which neighbours share a tile, enough to tell the tiles apart in shape().
+class BitMap {
+public:
+    int rows, columns;
+    int nextId;
+    int x, y;
+
+    static const int MAX_SIZE = 64;
+
+    // rows are not limited, a tile still has to fit one word of its column or row
+    static bool fits(const int &columns, const int &longestTile) {
+        return columns <= MAX_SIZE && longestTile <= MAX_SIZE;
+    }
+
+    BitMap(const ArrayMap &map)
+            : rows(map.rows), columns(map.columns), nextId(map.nextId), x(map.x), y(map.y),
+              rowMask(map.rows, 0), columnWords((map.rows + 63) / 64),
+              columnMask((size_t) (map.columns * columnWords), 0), rightLinks(map.rows, 0), downLinks(map.rows, 0),
+              freeRows(map.rows), verticalStarts(map.rows) {
+        fullRow = columns == MAX_SIZE ? ~0ULL : (1ULL << columns) - 1;
+        for (int iy = 0; iy < rows; iy++) {
+            for (int ix = 0; ix < columns; ix++) {
+                int shape = map.shape(ix, iy);
+                if (shape & CELL_COVERED)
+                    occupy(ix, iy);
+                if (shape & LINK_RIGHT)
+                    rightLinks[iy] |= 1ULL << ix;
+                if (shape & LINK_DOWN)
+                    downLinks[iy] |= 1ULL << ix;
+            }
+        }
+    }
+
+    uint64_t getRow(const int &iy) const {
+        return rowMask[iy];
+    }
+
+    int shape(const int &ix, const int &iy) const {
+        if (!((rowMask[iy] >> ix) & 1ULL))
+            return 0;
+        return CELL_COVERED | (int) ((rightLinks[iy] >> ix) & 1ULL) * LINK_RIGHT
+               | (int) ((downLinks[iy] >> ix) & 1ULL) * LINK_DOWN
+               | (ix > 0 ? (int) ((rightLinks[iy] >> (ix - 1)) & 1ULL) * LINK_LEFT : 0)
+               | (iy > 0 ? (int) ((downLinks[iy - 1] >> ix) & 1ULL) * LINK_UP : 0);
+    }
+
+    bool freeBlock() const {
+        return ((rowMask[y] >> x) & 1ULL) == 0;
+    }
+
+    bool isOnRightBottomCorner() const {
+        return x == columns - 1 && y == rows - 1;
+    }
+
+    void nextFree() {
+        int cx = x + 1;
+        int cy = y;
+        if (cx >= columns) {
+            cx = 0;
+            cy++;
+        }
+
+        for (; cy < rows; cy++, cx = 0) {
+            uint64_t free = ~rowMask[cy] & fullRow & (~0ULL << cx);
+            if (free) {
+                x = __builtin_ctzll(free);
+                y = cy;
+                return;
+            }
+        }
+        x = columns - 1;
+        y = rows - 1;
+    }
+
+    bool canPlaceHorizontal(const int &tile) const {
+        if (x + tile > columns)
+            return false;
+        return ((rowMask[y] >> x) & tileMask(tile)) == 0;
+    }
+
+    bool canPlaceVertical(const int &tile) const {
+        if (y + tile > rows)
+            return false;
+        return columnBits(x, y, tile) == 0;
+    }
+
+    Move placeHorizontalInPlace(const int &tile) {
+        Move move = {x, y, tile, false};
+        rowMask[y] |= tileMask(tile) << x;
+        rightLinks[y] |= tileMask(tile - 1) << x;
+        for (int i = x; i < x + tile; i++)
+            markColumn(i, y, 1, true);
+        nextId++;
+        nextFree();
+        return move;
+    }
+
+    Move placeVerticalInPlace(const int &tile) {
+        Move move = {x, y, tile, true};
+        markColumn(x, y, tile, true);
+        for (int i = y; i < y + tile; i++)
+            rowMask[i] |= 1ULL << x;
+        for (int i = y; i < y + tile - 1; i++)
+            downLinks[i] |= 1ULL << x;
+        nextId++;
+        nextFree();
+        return move;
+    }
+
+    void undo(const Move &move) {
+        if (move.vertical) {
+            markColumn(move.x, move.y, move.tile, false);
+            for (int i = move.y; i < move.y + move.tile; i++)
+                rowMask[i] &= ~(1ULL << move.x);
+            for (int i = move.y; i < move.y + move.tile - 1; i++)
+                downLinks[i] &= ~(1ULL << move.x);
+        } else {
+            rowMask[move.y] &= ~(tileMask(move.tile) << move.x);
+            rightLinks[move.y] &= ~(tileMask(move.tile - 1) << move.x);
+            for (int i = move.x; i < move.x + move.tile; i++)
+                markColumn(i, move.y, 1, false);
+        }
+        nextId--;
+        x = move.x;
+        y = move.y;
+    }
+
+    // free cells from the cursor on that no tile of given length can cover any more,
+    // cells before the cursor are decided and count as occupied. TILE above 0 is the length
+    // known at compile time, the loops over the tile unroll
+    template<int TILE = 0>
+    int deadCells(const int &length = TILE) const {
+        const int tile = TILE > 0 ? TILE : length;
+        uint64_t *free = freeRows.data();
+        uint64_t *verticalStart = verticalStarts.data();
+        for (int iy = y; iy < rows; iy++)
+            free[iy] = ~rowMask[iy] & fullRow & (iy == y ? ~0ULL << x : ~0ULL);
+
+        // columns with a free run of tile cells starting at row iy
+        for (int iy = y; iy + tile <= rows; iy++) {
+            verticalStart[iy] = free[iy];
+            for (int i = 1; i < tile; i++)
+                verticalStart[iy] &= free[iy + i];
+        }
+
+        int dead = 0;
+        for (int iy = y; iy < rows; iy++) {
+            uint64_t horizontalStart = free[iy];
+            for (int i = 1; i < tile; i++)
+                horizontalStart &= free[iy] >> i;
+
+            uint64_t covered = 0;
+            for (int i = 0; i < tile; i++) {
+                covered |= horizontalStart << i;
+                int start = iy - i;
+                if (start >= y && start + tile <= rows)
+                    covered |= verticalStart[start];
+            }
+            dead += __builtin_popcountll(free[iy] & ~covered);
+        }
+        return dead;
+    }
+
+    // tile ids for output -- start from the map this board was built of and place tiles in order
+    ArrayMap replay(const ArrayMap &start, const vector<Move> &moves) const {
+        ArrayMap map = start;
+        map.replay(moves, moves.size());
+        map.x = x;
+        map.y = y;
+        return map;
+    }
+
+private:
+    vector<uint64_t> rowMask;
+    int columnWords;             // words of one column
+    vector<uint64_t> columnMask; // column x from word x * columnWords on, bit y % 64 of word y / 64
+    vector<uint64_t> rightLinks; // bit x of row y -- cells x and x + 1 are one tile
+    vector<uint64_t> downLinks;  // bit x of row y -- rows y and y + 1 are one tile
+    uint64_t fullRow;
+    // deadCells() scratch, a row each
+    mutable vector<uint64_t> freeRows;
+    mutable vector<uint64_t> verticalStarts;
+
+    static uint64_t tileMask(const int &tile) {
+        return tile >= 64 ? ~0ULL : (1ULL << tile) - 1;
+    }
+
+    // cells iy .. iy + tile - 1 of column ix. A tile is at most 64 long, so two words at most
+    uint64_t columnBits(const int &ix, const int &iy, const int &tile) const {
+        const uint64_t *column = &columnMask[(size_t) (ix * columnWords + iy / 64)];
+        int shift = iy % 64;
+        uint64_t bits = column[0] >> shift;
+        if (shift + tile > 64)
+            bits |= column[1] << (64 - shift);
+        return bits & tileMask(tile);
+    }
+
+    void markColumn(const int &ix, const int &iy, const int &tile, const bool &value) {
+        uint64_t *column = &columnMask[(size_t) (ix * columnWords + iy / 64)];
+        int shift = iy % 64;
+        uint64_t low = tileMask(tile) << shift;
+        uint64_t high = shift + tile > 64 ? tileMask(tile) >> (64 - shift) : 0;
+        if (value) {
+            column[0] |= low;
+            if (high)
+                column[1] |= high;
+        } else {
+            column[0] &= ~low;
+            if (high)
+                column[1] &= ~high;
+        }
+    }
+
+    void occupy(const int &ix, const int &iy) {
+        rowMask[iy] |= 1ULL << ix;
+        markColumn(ix, iy, 1, true);
+    }
+};
+
+#endif //MI_PDP_BIT_MAP_H
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "array_map.h"
+#include "map_info.h"
+
+#ifndef MI_PDP_BRUTE_FORCE_H
+#define MI_PDP_BRUTE_FORCE_H
+
+using namespace std;
+
+// Reference for small boards -- every placement of tiles, no bound, no ordering, no shared code
+// with the solvers beyond MapInfo. Slow on purpose, anything it agrees with is right.
+class BruteForceSolver {
+public:
+    long long leaves; // complete boards seen
+
+    explicit BruteForceSolver(const MapInfo *info) : leaves(0), info(info) {
+        covered.assign((size_t) (info->rows * info->columns), false);
+        for (const auto &ban : info->banned)
+            covered[(size_t) (ban.second * info->columns + ban.first)] = true;
+    }
+
+    int solve() {
+        best = INT32_MIN;
+        search(0, 0);
+        return best;
+    }
+
+    // price of a solution map, or the reason it is not a valid one
+    static bool price(const MapInfo &info, const ArrayMap &map, int &price, string &error) {
+        // cells of every tile id, must be one straight run of i1 or i2 cells
+        struct Tile {
+            int cells = 0, minX = INT32_MAX, maxX = -1, minY = INT32_MAX, maxY = -1;
+        };
+        std::map<int, Tile> tiles;
+        price = 0;
+        for (int y = 0; y < info.rows; y++) {
+            for (int x = 0; x < info.columns; x++) {
+                int value = map.getValue(x, y);
+                if ((value == BLOCK_BAN) != info.isBanned(x, y)) {
+                    error = "cell " + to_string(x) + " " + to_string(y) + " banned in one of map and instance only";
+                    return false;
+                }
+                if (value == BLOCK_FREE)
+                    price += info.cn;
+                if (value <= 0)
+                    continue;
+                Tile &tile = tiles[value];
+                tile.cells++;
+                tile.minX = min(tile.minX, x);
+                tile.maxX = max(tile.maxX, x);
+                tile.minY = min(tile.minY, y);
+                tile.maxY = max(tile.maxY, y);
+            }
+        }
+        for (const auto &entry : tiles) {
+            const Tile &tile = entry.second;
+            int length = max(tile.maxX - tile.minX, tile.maxY - tile.minY) + 1;
+            bool straight = (tile.minX == tile.maxX || tile.minY == tile.maxY) && length == tile.cells;
+            if (!straight || (tile.cells != info.i1 && tile.cells != info.i2)) {
+                error = "tile " + to_string(entry.first) + " of " + to_string(tile.cells) + " cells at "
+                        + to_string(tile.minX) + " " + to_string(tile.minY) + " is not an I1 or I2 tile";
+                return false;
+            }
+            price += tile.cells == info.i2 ? info.c2 : info.c1;
+        }
+        return true;
+    }
+
+private:
+    const MapInfo *info;
+    vector<bool> covered;
+    int best;
+
+    bool fits(const int &x, const int &y, const int &length, const bool &vertical) const {
+        if (vertical ? y + length > info->rows : x + length > info->columns)
+            return false;
+        for (int i = 0; i < length; i++) {
+            if (covered[(size_t) (vertical ? (y + i) * info->columns + x : y * info->columns + x + i)])
+                return false;
+        }
+        return true;
+    }
+
+    void mark(const int &x, const int &y, const int &length, const bool &vertical, const bool &value) {
+        for (int i = 0; i < length; i++)
+            covered[(size_t) (vertical ? (y + i) * info->columns + x : y * info->columns + x + i)] = value;
+    }
+
+    // first free cell in scan order is either left empty or the left or top end of a tile
+    void search(int cell, const int &price) {
+        int cells = info->rows * info->columns;
+        while (cell < cells && covered[(size_t) cell])
+            cell++;
+        if (cell == cells) {
+            leaves++;
+            best = max(best, price);
+            return;
+        }
+
+        int x = cell % info->columns, y = cell / info->columns;
+        const int lengths[2] = {info->i1, info->i2};
+        const int prices[2] = {info->c1, info->c2};
+        for (int tile = 0; tile < 2; tile++) {
+            for (int vertical = 0; vertical < 2; vertical++) {
+                if (!fits(x, y, lengths[tile], vertical != 0))
+                    continue;
+                mark(x, y, lengths[tile], vertical != 0, true);
+                search(cell + 1, price + prices[tile]);
+                mark(x, y, lengths[tile], vertical != 0, false);
+            }
+        }
+        covered[(size_t) cell] = true;
+        search(cell + 1, price + info->cn);
+        covered[(size_t) cell] = false;
+    }
+};
+
+#endif //MI_PDP_BRUTE_FORCE_H
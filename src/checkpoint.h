@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "map_info.h"
+
+#ifndef MI_PDP_CHECKPOINT_H
+#define MI_PDP_CHECKPOINT_H
+
+using namespace std;
+
+// 'MPDC', file starts with it
+#define CHECKPOINT_MAGIC 0x4344504D
+// bump on any change of the layout
+#define CHECKPOINT_VERSION 1
+
+// State of a distributed search, enough to go on without what was finished -- best solution,
+// explored weight and the tasks left, packed the same way as work messages (QueueItem::pack()).
+// File is ints in host byte order -- magic, version, instance parameters, best price,
+// explored weight in two halves, size of packed best map, the map, task count, size of packed
+// tasks, the tasks.
+class Checkpoint {
+public:
+    int bestPrice = INT32_MIN;
+    vector<int> bestMap;  // ArrayMap::pack()
+    long long explored = 0; // weight of the tree finished, of TREE_WEIGHT
+    int taskCount = 0;
+    vector<int> tasks;
+
+    // written next to the target and renamed over it, a crash leaves the previous one whole
+    bool write(const string &file, const MapInfo &info) const {
+        string temporary = file + ".tmp";
+        vector<int> data = header(info);
+        data.push_back(bestPrice);
+        data.push_back((int) (explored >> 32));
+        data.push_back((int) (explored & 0xFFFFFFFFLL));
+        data.push_back((int) bestMap.size());
+        data.insert(data.end(), bestMap.begin(), bestMap.end());
+        data.push_back(taskCount);
+        data.push_back((int) tasks.size());
+        data.insert(data.end(), tasks.begin(), tasks.end());
+
+        {
+            ofstream os(temporary, ios::binary | ios::trunc);
+            os.write((const char *) data.data(), (streamsize) (data.size() * sizeof(int)));
+            if (!os.flush())
+                return false;
+        }
+        return rename(temporary.c_str(), file.c_str()) == 0;
+    }
+
+    // false when the file is missing, damaged or made for another instance
+    bool read(const string &file, const MapInfo &info) {
+        ifstream is(file, ios::binary);
+        vector<int> expected = header(info);
+        vector<int> found(expected.size());
+        if (!readInts(is, found.data(), found.size()) || found != expected)
+            return false;
+
+        int values[4];
+        if (!readInts(is, values, 4) || values[3] < 0)
+            return false;
+        bestPrice = values[0];
+        explored = ((long long) values[1] << 32) | (unsigned int) values[2];
+        bestMap.resize((size_t) values[3]);
+        if (!readInts(is, bestMap.data(), bestMap.size()))
+            return false;
+
+        if (!readInts(is, values, 2) || values[0] < 0 || values[1] < 0)
+            return false;
+        taskCount = values[0];
+        tasks.resize((size_t) values[1]);
+        return readInts(is, tasks.data(), tasks.size());
+    }
+
+private:
+    static vector<int> header(const MapInfo &info) {
+        vector<int> data = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, info.rows, info.columns, info.i1, info.i2,
+                            info.c1, info.c2, info.cn, info.k};
+        for (const auto &ban : info.banned) {
+            data.push_back(ban.first);
+            data.push_back(ban.second);
+        }
+        return data;
+    }
+
+    static bool readInts(istream &is, int *data, const size_t &count) {
+        is.read((char *) data, (streamsize) (count * sizeof(int)));
+        return (size_t) is.gcount() == count * sizeof(int);
+    }
+};
+
+#endif //MI_PDP_CHECKPOINT_H
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "map_info.h"
+
+#ifndef MI_PDP_INSTANCE_GENERATOR_H
+#define MI_PDP_INSTANCE_GENERATOR_H
+
+using namespace std;
+
+enum class BanPattern {
+    RANDOM,      // every cell banned with probability density
+    ADVERSARIAL, // ... and diagonals every i2 cells, see InstanceGenerator
+};
+
+struct GeneratorConfig {
+    int rows = 10;
+    int columns = 10;
+    double density = 0.1;
+    int i1 = 3;
+    int i2 = 5;
+    int c1 = 1;
+    int c2 = 3;
+    int cn = -2;
+    BanPattern pattern = BanPattern::RANDOM;
+};
+
+// Random instances of given size, tiles and prices. Same seed, same instance on every rank.
+//
+// ADVERSARIAL bans a cell on every i2-th diagonal, no free run of a row or column is i2 long and
+// no I2 tile fits anywhere. The bound of MapInfo does not see that, it prices the free cells as if
+// the best tile covered them, so with I2 the best tile the bound stays far above every solution
+// and prunes little.
+class InstanceGenerator {
+public:
+    explicit InstanceGenerator(const unsigned int &seed) : random(seed) {
+    }
+
+    MapInfo *generate(const GeneratorConfig &config) {
+        int cells = config.rows * config.columns;
+        vector<uint64_t> banned(MapInfo::bitmapWords(cells), 0);
+        bernoulli_distribution ban(config.density);
+        int k = 0;
+        for (int cell = 0; cell < cells; cell++) {
+            int x = cell % config.columns, y = cell / config.columns;
+            bool diagonal = config.pattern == BanPattern::ADVERSARIAL && config.i2 > 1
+                            && (x + y) % config.i2 == config.i2 - 1;
+            if (diagonal || ban(random)) {
+                banned[(size_t) cell / 64] |= 1ULL << (cell % 64);
+                k++;
+            }
+        }
+        MapInfo *info = new MapInfo(config.rows, config.columns, config.i1, config.i2, config.c1, config.c2,
+                                    config.cn, k);
+        info->setBanned(move(banned));
+        return info;
+    }
+
+    // small board with random tiles and prices, for checks against BruteForceSolver
+    MapInfo *generateSmall(const int &maxSide) {
+        GeneratorConfig config;
+        config.i1 = uniform_int_distribution<int>(1, 3)(random);
+        // tiles of length 1 fit every cell, brute force would try them all on a board of any size
+        uniform_int_distribution<int> side(1, config.i1 == 1 ? min(maxSide, 3) : maxSide);
+        config.rows = side(random);
+        config.columns = side(random);
+        config.density = uniform_real_distribution<double>(0, 0.4)(random);
+        config.i2 = uniform_int_distribution<int>(config.i1 + 1, 5)(random);
+        uniform_int_distribution<int> price(-3, 6);
+        config.c1 = price(random);
+        config.c2 = price(random);
+        config.cn = price(random);
+        config.pattern = bernoulli_distribution(0.2)(random) ? BanPattern::ADVERSARIAL : BanPattern::RANDOM;
+        return generate(config);
+    }
+
+private:
+    mt19937 random;
+};
+
+#endif //MI_PDP_INSTANCE_GENERATOR_H
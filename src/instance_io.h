@@ -0,0 +1,308 @@
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "map_info.h"
+
+#ifndef MI_PDP_INSTANCE_IO_H
+#define MI_PDP_INSTANCE_IO_H
+
+using namespace std;
+
+// 'MPDI', binary instance starts with it
+#define INSTANCE_MAGIC 0x4944504D
+// bump on any change of the binary layout
+#define INSTANCE_VERSION 1
+// magic, version, rows, columns, i1, i2, c1, c2, cn, k
+#define INSTANCE_HEADER_INTS 10
+// Move::pack() has 12 bits for a coordinate and 7 for a tile
+#define MAX_SIDE 4096
+#define MAX_TILE 127
+
+// Instance files come in two formats, both read straight from a memory mapped file and checked
+// on the way -- an error names what was expected and, for text, the line.
+//
+// text:   rows columns, i1 i2 c1 c2 cn, k and k banned x y pairs, whitespace separated
+// binary: ints magic, version, rows, columns, i1, i2, c1, c2, cn, k in host byte order, then
+//         one bit per cell in row major order, lowest bit first, set when the cell is banned.
+//         Bits are MapInfo::bannedBitmap() as it is in memory of a little endian host
+
+// integers of a text instance one by one, no copies of the text
+class TextScanner {
+public:
+    TextScanner(const char *data, const size_t &size) : position(data), end(data + size), line(1) {
+    }
+
+    // false leaves the scanner on what is there instead, for failure()
+    bool next(int &value) {
+        skipSpace();
+        if (position == end)
+            return false;
+        const char *start = position;
+        bool negative = *position == '-';
+        if (negative || *position == '+')
+            position++;
+        long long number = 0;
+        const char *digits = position;
+        while (position != end && *position >= '0' && *position <= '9') {
+            number = number * 10 + (*position - '0');
+            if (number > (long long) INT_MAX + 1)
+                break;
+            position++;
+        }
+        bool separated = position == end || isSpace(*position);
+        if (position == digits || !separated || number > (long long) INT_MAX + negative) {
+            position = start;
+            return false;
+        }
+        value = (int) (negative ? -number : number);
+        return true;
+    }
+
+    string failure(const string &what) const {
+        return where() + "expected " + what + ", found " + (position == end ? "end of file" : "'" + token() + "'");
+    }
+
+    // only whitespace left
+    bool finished(string &error) {
+        skipSpace();
+        if (position == end)
+            return true;
+        error = where() + "unexpected '" + token() + "' after the last banned cell";
+        return false;
+    }
+
+    string where() const {
+        return "line " + to_string(line) + ": ";
+    }
+
+private:
+    const char *position;
+    const char *end;
+    int line;
+
+    static bool isSpace(const char &c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    void skipSpace() {
+        for (; position != end && isSpace(*position); position++) {
+            if (*position == '\n')
+                line++;
+        }
+    }
+
+    string token() const {
+        const char *stop = position;
+        while (stop != end && !isSpace(*stop) && stop - position < 20)
+            stop++;
+        return string(position, stop);
+    }
+};
+
+// parameters in the order of the file, nullptr and the reason when the solver cannot take them
+inline MapInfo *checkedInstance(const int *values, string &error) {
+    int rows = values[0], columns = values[1], i1 = values[2], i2 = values[3];
+    int c1 = values[4], c2 = values[5], cn = values[6], k = values[7];
+    if (rows < 1 || rows > MAX_SIDE || columns < 1 || columns > MAX_SIDE) {
+        error = "board " + to_string(rows) + "x" + to_string(columns) + " outside 1x1 .. "
+                + to_string(MAX_SIDE) + "x" + to_string(MAX_SIDE);
+        return nullptr;
+    }
+    if (i1 < 1 || i1 > MAX_TILE || i2 < 1 || i2 > MAX_TILE) {
+        error = "tile lengths " + to_string(i1) + " and " + to_string(i2) + " outside 1 .. " + to_string(MAX_TILE);
+        return nullptr;
+    }
+    long long cells = (long long) rows * columns;
+    long long price = max(max(llabs(c1), llabs(c2)), llabs(cn));
+    if (price * cells > INT_MAX) {
+        error = "prices up to " + to_string(price) + " on " + to_string(cells) + " cells overflow int";
+        return nullptr;
+    }
+    if (k < 0 || k > cells) {
+        error = to_string(k) + " banned cells on a board of " + to_string(cells);
+        return nullptr;
+    }
+    return new MapInfo(rows, columns, i1, i2, c1, c2, cn, k);
+}
+
+inline MapInfo *parseText(const char *data, const size_t &size, string &error) {
+    static const char *names[8] = {"rows", "columns", "i1", "i2", "c1", "c2", "cn", "banned count k"};
+    TextScanner scanner(data, size);
+    int values[8];
+    for (int i = 0; i < 8; i++) {
+        if (!scanner.next(values[i])) {
+            error = scanner.failure(names[i]);
+            return nullptr;
+        }
+    }
+    MapInfo *info = checkedInstance(values, error);
+    if (!info)
+        return nullptr;
+
+    vector<uint64_t> cells(MapInfo::bitmapWords(info->rows * info->columns), 0);
+    for (int i = 0; i < info->k; i++) {
+        int x = 0, y = 0;
+        bool read = scanner.next(x) && scanner.next(y);
+        bool inside = read && x >= 0 && x < info->columns && y >= 0 && y < info->rows;
+        size_t cell = inside ? (size_t) (y * info->columns + x) : 0;
+        if (!inside || (cells[cell / 64] >> (cell % 64) & 1)) {
+            string what = "banned cell " + to_string(i + 1) + " of " + to_string(info->k);
+            if (!read)
+                error = scanner.failure(what + " as x y");
+            else
+                error = scanner.where() + what + " at " + to_string(x) + " " + to_string(y)
+                        + (inside ? " is banned twice" : " is off the board");
+            delete info;
+            return nullptr;
+        }
+        cells[cell / 64] |= 1ULL << (cell % 64);
+    }
+    if (!scanner.finished(error)) {
+        delete info;
+        return nullptr;
+    }
+    info->setBanned(move(cells));
+    return info;
+}
+
+inline bool isBinaryInstance(const char *data, const size_t &size) {
+    int magic;
+    if (size < sizeof(int))
+        return false;
+    memcpy(&magic, data, sizeof(int));
+    return magic == INSTANCE_MAGIC;
+}
+
+inline bool isBinaryInstanceFile(const string &file) {
+    char magic[sizeof(int)];
+    ifstream is(file, ios::binary);
+    is.read(magic, sizeof(magic));
+    return isBinaryInstance(magic, (size_t) is.gcount());
+}
+
+inline MapInfo *parseBinary(const char *data, const size_t &size, string &error) {
+    int header[INSTANCE_HEADER_INTS];
+    if (size < sizeof(header)) {
+        error = "binary header cut short";
+        return nullptr;
+    }
+    memcpy(header, data, sizeof(header));
+    if (header[1] != INSTANCE_VERSION) {
+        error = "binary version " + to_string(header[1]) + ", expected " + to_string(INSTANCE_VERSION);
+        return nullptr;
+    }
+    MapInfo *info = checkedInstance(header + 2, error);
+    if (!info)
+        return nullptr;
+
+    size_t cellCount = (size_t) (info->rows * info->columns);
+    size_t expected = sizeof(header) + (cellCount + 7) / 8;
+    if (size != expected) {
+        error = "binary of " + to_string(size) + " bytes, the board needs " + to_string(expected);
+        delete info;
+        return nullptr;
+    }
+    // bytes lowest bit first are the words of the bitmap on a little endian host
+    vector<uint64_t> cells(MapInfo::bitmapWords((int) cellCount), 0);
+    memcpy(cells.data(), data + sizeof(header), expected - sizeof(header));
+    // bits past the last cell must be clear, anything else is not what writeBinary() made
+    if (cellCount % 64 != 0 && cells.back() >> (cellCount % 64) != 0) {
+        error = "binary has bits set past the last cell";
+        delete info;
+        return nullptr;
+    }
+    int count = 0;
+    for (const uint64_t &word : cells)
+        count += __builtin_popcountll(word);
+    if (count != info->k) {
+        error = "binary has " + to_string(count) + " banned cells, header says " + to_string(info->k);
+        delete info;
+        return nullptr;
+    }
+    info->setBanned(move(cells));
+    return info;
+}
+
+inline MapInfo *parseInstance(const char *data, const size_t &size, string &error) {
+    if (isBinaryInstance(data, size))
+        return parseBinary(data, size, error);
+    return parseText(data, size, error);
+}
+
+// either format from a file, nullptr and the reason when it cannot be used
+inline MapInfo *loadInstance(const string &file, string &error) {
+    int descriptor = open(file.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        error = file + ": " + strerror(errno);
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0) {
+        error = file + ": " + strerror(errno);
+        close(descriptor);
+        return nullptr;
+    }
+    // nothing to map
+    if (info.st_size == 0) {
+        error = file + ": empty file";
+        close(descriptor);
+        return nullptr;
+    }
+    size_t size = (size_t) info.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) {
+        error = file + ": " + strerror(errno);
+        return nullptr;
+    }
+    MapInfo *result = parseInstance((const char *) data, size, error);
+    munmap(data, size);
+    if (!result)
+        error = file + ": " + error;
+    return result;
+}
+
+// for streams that cannot be mapped, the whole stream is read first
+inline MapInfo *load(istream &is, string &error) {
+    string data((istreambuf_iterator<char>(is)), istreambuf_iterator<char>());
+    return parseInstance(data.data(), data.size(), error);
+}
+
+inline void writeText(ostream &os, const MapInfo &info) {
+    os << info.rows << " " << info.columns << "\n"
+       << info.i1 << " " << info.i2 << " " << info.c1 << " " << info.c2 << " " << info.cn << "\n"
+       << info.k << "\n";
+    for (const auto &ban : info.banned)
+        os << ban.first << " " << ban.second << "\n";
+}
+
+inline void writeBinary(ostream &os, const MapInfo &info) {
+    int header[INSTANCE_HEADER_INTS] = {INSTANCE_MAGIC, INSTANCE_VERSION, info.rows, info.columns,
+                                        info.i1, info.i2, info.c1, info.c2, info.cn, info.k};
+    os.write((const char *) header, sizeof(header));
+    os.write((const char *) info.bannedBitmap().data(), (streamsize) (((size_t) (info.rows * info.columns) + 7) / 8));
+}
+
+// false when the file cannot be written
+inline bool saveInstance(const string &file, const MapInfo &info, const bool &binary) {
+    ofstream os(file, binary ? ios::out | ios::binary | ios::trunc : ios::out | ios::trunc);
+    if (binary)
+        writeBinary(os, info);
+    else
+        writeText(os, info);
+    return (bool) os.flush();
+}
+
+#endif //MI_PDP_INSTANCE_IO_H
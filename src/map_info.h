@@ -1,5 +1,7 @@
-#include <set>
+#include <cstdint>
+#include <vector>
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
@@ -18,37 +20,88 @@ public:
     int k;
     int startUncovered;
     int optimPrice;
-    set<pair<int, int>> banned;
+    vector<pair<int, int>> banned; // x y pairs, sorted
 
     MapInfo(int rows, int columns, int i1, int i2, int c1, int c2, int cn, int k)
             : rows(rows), columns(columns), i1(i1), i2(i2), c1(c1), c2(c2), cn(cn), k(k),
-              startUncovered(rows * columns - k)/* map(rows, columns)*/ {
-        optimPrice = computeUpperPrice(startUncovered);
+              startUncovered(rows * columns - k), bannedCells(bitmapWords(rows * columns), 0) {
+        computeUpperPrices();
+        optimPrice = getUpperPrice(startUncovered);
     }
 
-    void addBanned(const int &x, const int &y) {
-        banned.insert(make_pair(x, y));
+    // computeUpperPrice() for every count of uncovered squares the search can meet
+    int getUpperPrice(const int &uncovered) const {
+        return upperPrices[uncovered];
+    }
+
+    // 64 cells per word of a banned cell bitmap
+    static size_t bitmapWords(const int &cells) {
+        return ((size_t) cells + 63) / 64;
+    }
+
+    bool isBanned(const int &x, const int &y) const {
+        size_t cell = (size_t) (y * columns + x);
+        return (bannedCells[cell / 64] >> (cell % 64) & 1) != 0;
+    }
+
+    // all banned cells at once from a row major bitmap of bitmapWords() words. Counted by
+    // column first, then every column is filled top down -- sorted without a sort
+    void setBanned(vector<uint64_t> cells) {
+        bannedCells = move(cells);
+        vector<int> start((size_t) columns + 1, 0);
+        forEachBanned([&start](const int &x, const int &) { start[(size_t) x + 1]++; });
+        for (int x = 0; x < columns; x++)
+            start[(size_t) x + 1] += start[(size_t) x];
+        banned.resize((size_t) start[(size_t) columns]);
+        forEachBanned([this, &start](const int &x, const int &y) {
+            banned[(size_t) start[(size_t) x]++] = make_pair(x, y);
+        });
+    }
+
+    const vector<uint64_t> &bannedBitmap() const {
+        return bannedCells;
     }
 
     int computeUpperPrice(int number) const {
         // vraci maximalni cenu pro "number" nevyresenych policek
-        // returns the maximal price for the "number" of unsolved squares
-        int i, x;
-        int max = c2 * (number / i2);
-        int zb = number % i2;
-        max += c1 * (zb / i1);
-        zb = zb % i1;
-        max += zb * cn;
-        for (i = 0; i < (number / i2); i++) {
-            x = c2 * i;
-            zb = number - i * i2;
-            x += c1 * (zb / i1);
-            zb = zb % i1;
-            x += zb * cn;
-            if (x > max) max = x;
+        // returns the maximal price for the "number" of unsolved squares -- any count of I2
+        // and I1 tiles that fits, the rest left empty. Empty cells may pay more than a tile
+        int max = INT32_MIN;
+        for (int a = 0; a * i2 <= number; a++) {
+            for (int b = 0; a * i2 + b * i1 <= number; b++)
+                max = std::max(max, a * c2 + b * c1 + (number - a * i2 - b * i1) * cn);
         }
         return max;
     }
+
+private:
+    vector<uint64_t> bannedCells; // row major, bit per cell
+    vector<int> upperPrices;
+
+    // banned cells in row major order, set bits only
+    template<class Visit>
+    void forEachBanned(const Visit &visit) const {
+        for (size_t word = 0; word < bannedCells.size(); word++) {
+            for (uint64_t bits = bannedCells[word]; bits; bits &= bits - 1) {
+                int cell = (int) (word * 64 + (size_t) __builtin_ctzll(bits));
+                visit(cell % columns, cell / columns);
+            }
+        }
+    }
+
+    // same maximum as computeUpperPrice(), the best split of n squares ends with an empty
+    // square, an I1 or an I2 tile after the best split of the rest
+    void computeUpperPrices() {
+        upperPrices.assign(startUncovered + 1, 0);
+        for (int n = 1; n <= startUncovered; n++) {
+            int best = upperPrices[n - 1] + cn;
+            if (n >= i1)
+                best = std::max(best, upperPrices[n - i1] + c1);
+            if (n >= i2)
+                best = std::max(best, upperPrices[n - i2] + c2);
+            upperPrices[n] = best;
+        }
+    }
 };
 
 #endif //MI_PDP_MAP_INFO_H
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "array_map.h"
+#include "map_info.h"
+#include "solver_result.h"
+
+#ifndef MI_PDP_PROFILE_SOLVER_H
+#define MI_PDP_PROFILE_SOLVER_H
+
+using namespace std;
+
+// Exact engine for narrow boards -- broken profile dynamic programming over the row-major scan
+// of ArrayMap::nextFree(). State is the cursor cell plus the profile, a bitmask of cells from
+// the cursor on that are already covered by tiles placed before it. A vertical tile reaches
+// (max tile - 1) rows down, so the profile has (max tile - 1) * width + 1 bits. Boards wider
+// than high are scanned along columns to keep the profile short.
+//
+// A first pass keeps only the beamWidth best states of every cell and gives a feasible price,
+// the exact pass then drops states whose upper bound cannot reach it.
+//
+// Only the layers of the current and the next cell hold whole states. Every layer leaves behind
+// just the link of each state to its parent in the layer before, which rebuild() follows back.
+// Links still grow with cells times states per cell, the pass gives up once they are bound to
+// outgrow maxStates.
+class ProfileSolver {
+public:
+    static const int MAX_PROFILE = 64;
+
+    size_t states; // states kept by the exact pass
+    size_t widest; // most states of one cell in the exact pass
+    int beamWidth;
+    size_t maxStates;
+
+    static int profileBits(const MapInfo &info) {
+        int width = min(info.rows, info.columns);
+        return (max(info.i1, info.i2) - 1) * width + 1;
+    }
+
+    ProfileSolver(const MapInfo *info, const size_t &maxStates = SIZE_MAX, const int &beamWidth = 256)
+            : states(0), widest(0), beamWidth(beamWidth), maxStates(maxStates), info(info) {
+        transposed = info->columns > info->rows;
+        width = transposed ? info->rows : info->columns;
+        height = transposed ? info->columns : info->rows;
+
+        banned.assign((size_t) (width * height), false);
+        for (const auto &ban : info->banned)
+            banned[(size_t) scanIndex(ban.first, ban.second)] = true;
+
+        tiles[0] = {info->i2, info->c2};
+        tiles[1] = {info->i1, info->c1};
+
+        int n = width * height;
+        freeFrom.assign((size_t) (n + 1), 0);
+        for (int cell = n - 1; cell >= 0; cell--)
+            freeFrom[(size_t) cell] = freeFrom[(size_t) (cell + 1)] + (banned[(size_t) cell] ? 0 : 1);
+    }
+
+    // price INT32_MIN when the states of the exact pass do not fit into maxStates or into memory
+    SolverResult solve() {
+        incumbent = INT32_MIN;
+        bool complete = true;
+        try {
+            if (beamWidth > 0 && run(beamWidth))
+                incumbent = layer.front().price;
+            complete = run(0);
+        } catch (const bad_alloc &) {
+            complete = false;
+        }
+        states = trail.size();
+
+        if (!complete) {
+            release();
+            ArrayMap empty(info->rows, info->columns, info->banned);
+            empty.setStart();
+            SolverResult result(empty);
+            result.price = INT32_MIN;
+            return result;
+        }
+        int price = layer.front().price;
+        release();
+        SolverResult result = rebuild();
+        result.price = price;
+        result.findLeftEmptyTiles();
+        return result;
+    }
+
+private:
+    // enumerators, push() takes them by reference and static const ints would need a definition
+    enum {
+        CHOICE_PASS = 0, // cell banned or covered already
+        CHOICE_SKIP = 1,
+        CHOICE_TILE = 2, // + 2 * tile + vertical
+    };
+
+    // link: index of the parent in the layer before << 3 | choice
+    struct State {
+        uint64_t profile;
+        int price;
+        uint32_t link;
+    };
+
+    struct Tile {
+        int length;
+        int price;
+    };
+
+    const MapInfo *info;
+    bool transposed;
+    int width, height;
+    vector<bool> banned;
+    vector<int> freeFrom; // not banned cells from the index to the end
+    Tile tiles[2];
+    vector<State> layer, next; // states before and after the cell being expanded
+    vector<uint32_t> trail;    // links of all layers one after another
+    vector<size_t> layerStart; // first link of the layer after every cell
+    int incumbent;             // price of a known solution, states that cannot reach it are dropped
+
+    // open addressing index of the profiles in the next layer
+    vector<int> slots;
+    uint64_t slotMask;
+    int slotShift;        // keeps the top bits of the multiplicative hash
+    vector<size_t> used;  // slots taken in this layer, cleared before the next one
+
+    // one pass over all cells, beam > 0 keeps only that many best states per cell. False when the
+    // links outgrow maxStates. Nothing can stick out past the last cell, so the last layer holds
+    // the empty profile only
+    bool run(const int &beam) {
+        int n = width * height;
+        layer.assign(1, {0, 0, CHOICE_PASS});
+        trail.clear();
+        layerStart.assign((size_t) n, 0);
+        for (int cell = 0; cell < n; cell++) {
+            next.clear();
+            // every state expands to at most five, keep the table under 5/8 full
+            resizeSlots(layer.size() * 8);
+            for (size_t state = 0; state < layer.size(); state++)
+                expand(cell, (uint32_t) state);
+            for (const size_t &i : used)
+                slots[i] = -1;
+            used.clear();
+
+            if (beam > 0 && next.size() > (size_t) beam) {
+                nth_element(next.begin(), next.begin() + beam, next.end(), [](const State &a, const State &b) {
+                    return a.price > b.price;
+                });
+                next.resize((size_t) beam);
+            }
+            // links keep 29 bits for the parent. States per cell so far times all cells tells early
+            // that the pass will not fit, rows of a long board each hold about as many
+            if (next.size() > maxStates - trail.size() || next.size() > (1U << 29)
+                || (trail.size() + next.size()) / (size_t) (cell + 1) > maxStates / (size_t) n)
+                return false;
+            if (beam == 0)
+                widest = max(widest, next.size());
+            layerStart[(size_t) cell] = trail.size();
+            for (const State &state : next)
+                trail.push_back(state.link);
+            layer.swap(next);
+        }
+        return true;
+    }
+
+    // states and the hash table go before rebuild() needs memory of its own
+    void release() {
+        vector<State>().swap(layer);
+        vector<State>().swap(next);
+        vector<int>().swap(slots);
+        vector<size_t>().swap(used);
+    }
+
+    void resizeSlots(const size_t &count) {
+        size_t size = max((size_t) 16, slots.size());
+        while (size < count)
+            size *= 2;
+        if (slots.size() < size)
+            slots.assign(size, -1);
+        slotMask = size - 1;
+        slotShift = 64 - __builtin_ctzll(size);
+    }
+
+    size_t slot(const uint64_t &profile) const {
+        size_t i = (size_t) ((profile * 0x9E3779B97F4A7C15ULL) >> slotShift) & slotMask;
+        while (slots[i] != -1 && next[(size_t) slots[i]].profile != profile)
+            i = (i + 1) & slotMask;
+        return i;
+    }
+
+    int scanIndex(const int &x, const int &y) const {
+        return transposed ? x * width + y : y * width + x;
+    }
+
+    void push(const int &cell, const uint64_t &profile, const int &price, const uint32_t &parent, const int &choice) {
+        // cells from the next one on that are neither banned nor covered yet
+        int uncovered = freeFrom[(size_t) (cell + 1)] - __builtin_popcountll(profile);
+        if (price + info->getUpperPrice(uncovered) < incumbent)
+            return;
+
+        size_t i = slot(profile);
+        if (slots[i] == -1) {
+            slots[i] = (int) next.size();
+            used.push_back(i);
+            next.push_back({profile, price, parent << 3 | (uint32_t) choice});
+        } else if (price > next[(size_t) slots[i]].price) {
+            next[(size_t) slots[i]] = {profile, price, parent << 3 | (uint32_t) choice};
+        }
+    }
+
+    void expand(const int &cell, const uint32_t &state) {
+        uint64_t profile = layer[(size_t) state].profile;
+        int price = layer[(size_t) state].price;
+
+        if (banned[(size_t) cell] || (profile & 1ULL)) {
+            push(cell, profile >> 1, price, state, CHOICE_PASS);
+            return;
+        }
+
+        int x = cell % width;
+        int y = cell / width;
+        for (int t = 0; t < 2; t++) {
+            const Tile &tile = tiles[t];
+
+            // horizontal
+            if (x + tile.length <= width) {
+                uint64_t cover = 0;
+                bool fits = true;
+                for (int i = 0; i < tile.length && fits; i++) {
+                    fits = !banned[(size_t) (cell + i)] && !(profile & (1ULL << i));
+                    cover |= 1ULL << i;
+                }
+                if (fits)
+                    push(cell, (profile | cover) >> 1, price + tile.price, state, CHOICE_TILE + 2 * t);
+            }
+
+            // vertical
+            if (y + tile.length <= height) {
+                uint64_t cover = 0;
+                bool fits = true;
+                for (int i = 0; i < tile.length && fits; i++) {
+                    fits = !banned[(size_t) (cell + i * width)] && !(profile & (1ULL << (i * width)));
+                    cover |= 1ULL << (i * width);
+                }
+                if (fits)
+                    push(cell, (profile | cover) >> 1, price + tile.price, state, CHOICE_TILE + 2 * t + 1);
+            }
+        }
+
+        push(cell, profile >> 1, price + info->cn, state, CHOICE_SKIP);
+    }
+
+    // walk the choices back, tile ids then go in the order the branch and bound places them
+    SolverResult rebuild() const {
+        vector<Move> moves;
+        uint32_t state = 0;
+        for (int cell = width * height - 1; cell >= 0; cell--) {
+            uint32_t link = trail[layerStart[(size_t) cell] + state];
+            int choice = (int) (link & 7);
+            if (choice >= CHOICE_TILE) {
+                int t = (choice - CHOICE_TILE) / 2;
+                bool vertical = ((choice - CHOICE_TILE) % 2) == 1;
+                int sx = cell % width;
+                int sy = cell / width;
+                if (transposed)
+                    moves.push_back({sy, sx, tiles[t].length, !vertical});
+                else
+                    moves.push_back({sx, sy, tiles[t].length, vertical});
+            }
+            state = link >> 3;
+        }
+
+        sort(moves.begin(), moves.end(), [](const Move &a, const Move &b) {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        });
+
+        ArrayMap map(info->rows, info->columns, info->banned);
+        map.replay(moves, moves.size());
+        return SolverResult(map);
+    }
+};
+
+#endif //MI_PDP_PROFILE_SOLVER_H
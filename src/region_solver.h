@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <mpi.h>
+
+#include "array_map.h"
+#include "map_info.h"
+#include "profile_solver.h"
+#include "solver.h"
+#include "solver_result.h"
+
+#ifndef MI_PDP_REGION_SOLVER_H
+#define MI_PDP_REGION_SOLVER_H
+
+using namespace std;
+
+// free cells of the board no tile can join with any other, in the box around them
+struct Region {
+    int x, y; // top left corner of the box on the board
+    int columns, rows;
+    int cells;                // free cells of the region
+    vector<uint64_t> banned; // row major bitmap of the box, cells of other regions banned as well
+};
+
+// Tiles are straight runs of free cells. Two free neighbours can share a tile only when the run of
+// free cells through both, along their row or column, fits the shorter tile. Banned cells or runs too
+// short for any tile cut the board into regions no tile spans, and the best price of the board is the
+// sum of the best prices of its regions.
+//
+// Every region is solved alone on its box, the rest of the box banned. Boxes with the same banned
+// cells are solved once. A box whose profile fits goes to ProfileSolver on rank 0; any other is
+// split over all ranks by the usual Solver. Maps of the regions are put into one with new tile ids.
+// In anytime mode every box gets a share of the time left by its free cells.
+class RegionSolver {
+public:
+    vector<Region> regions;
+    int searched; // boxes solved, the other regions had the shape of one of them
+    bool optimal; // rank 0 -- every box was solved to the end
+
+    RegionSolver(const MapInfo *info, const SolverConfig &config)
+            : regions(findRegions(*info)), searched(0), optimal(true), info(info), config(config) {
+    }
+
+    // worth solving by regions -- more than one and the run keeps no checkpoint
+    bool split() const {
+        return config.regions && config.checkpointFile.empty() && config.resumeFile.empty() && regions.size() > 1;
+    }
+
+    // all ranks must call it, result is valid on rank 0 only
+    SolverResult solve() {
+        int rank, procs;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &procs);
+        double start = MPI_Wtime();
+
+        ArrayMap map(info->rows, info->columns, info->banned);
+        map.setStart();
+        SolverResult result(map);
+        result.price = 0;
+        // box of every region, -1 for a lone cell. Boxes of the same shape are one, solved by the
+        // first region of the shape
+        std::map<vector<uint64_t>, int> shapes; // box size and banned cells, index into boxes
+        vector<int> boxOf;
+        vector<size_t> boxes;
+        int cellsLeft = 0;
+        for (size_t i = 0; i < regions.size(); i++) {
+            const Region &region = regions[i];
+            // a lone cell takes no tile unless one of length 1
+            if (region.cells == 1 && min(info->i1, info->i2) > 1) {
+                boxOf.push_back(-1);
+                continue;
+            }
+            vector<uint64_t> shape = region.banned;
+            shape.push_back((uint64_t) region.columns << 32 | (uint64_t) region.rows);
+            auto known = shapes.insert(make_pair(shape, (int) boxes.size())).first;
+            if (known->second == (int) boxes.size()) {
+                boxes.push_back(i);
+                cellsLeft += region.cells;
+            }
+            boxOf.push_back(known->second);
+        }
+
+        vector<SolverResult> solved;
+        for (const size_t &i : boxes) {
+            // anytime mode -- share of the time left by free cells, time a box does not use goes to the next
+            SolverConfig boxConfig = config;
+            if (config.timeLimit > 0) {
+                double left = config.timeLimit - (MPI_Wtime() - start);
+                boxConfig.timeLimit = std::max(left * regions[i].cells / cellsLeft, 1e-3);
+            }
+            cellsLeft -= regions[i].cells;
+            solved.push_back(solveBox(regions[i], boxConfig, rank, procs));
+        }
+        searched = (int) boxes.size();
+
+        int nextId = 1;
+        for (size_t i = 0; i < regions.size(); i++) {
+            if (boxOf[i] < 0)
+                result.price += info->cn;
+            else if (rank == 0)
+                nextId = place(result, solved[(size_t) boxOf[i]], regions[i], nextId);
+        }
+        result.map.nextId = nextId;
+        result.findLeftEmptyTiles();
+        return result;
+    }
+
+    // free cells joined along runs of free cells at least as long as the shorter tile, in the order
+    // of their first cell
+    static vector<Region> findRegions(const MapInfo &info) {
+        int shortest = min(info.i1, info.i2);
+        int cells = info.rows * info.columns;
+        // length of the run of free cells through every cell, along its row and its column
+        vector<int> across((size_t) cells, 0), down((size_t) cells, 0);
+        for (int y = 0; y < info.rows; y++) {
+            for (int x = 0; x < info.columns;) {
+                int end = x;
+                while (end < info.columns && !info.isBanned(end, y))
+                    end++;
+                for (int i = x; i < end; i++)
+                    across[(size_t) (y * info.columns + i)] = end - x;
+                x = end + 1;
+            }
+        }
+        for (int x = 0; x < info.columns; x++) {
+            for (int y = 0; y < info.rows;) {
+                int end = y;
+                while (end < info.rows && !info.isBanned(x, end))
+                    end++;
+                for (int i = y; i < end; i++)
+                    down[(size_t) (i * info.columns + x)] = end - y;
+                y = end + 1;
+            }
+        }
+
+        vector<Region> regions;
+        vector<int> region((size_t) cells, -1), stack;
+        for (int first = 0; first < cells; first++) {
+            if (info.isBanned(first % info.columns, first / info.columns) || region[(size_t) first] >= 0)
+                continue;
+            int id = (int) regions.size();
+            vector<int> members;
+            region[(size_t) first] = id;
+            stack.push_back(first);
+            while (!stack.empty()) {
+                int cell = stack.back();
+                stack.pop_back();
+                members.push_back(cell);
+                int x = cell % info.columns;
+                // left and right along the row run, up and down along the column run
+                int neighbours[4] = {x > 0 ? cell - 1 : -1, x + 1 < info.columns ? cell + 1 : -1,
+                                     cell - info.columns, cell + info.columns};
+                for (int i = 0; i < 4; i++) {
+                    int next = neighbours[i];
+                    bool joined = i < 2 ? across[(size_t) cell] >= shortest : down[(size_t) cell] >= shortest;
+                    if (!joined || next < 0 || next >= cells || region[(size_t) next] >= 0
+                        || info.isBanned(next % info.columns, next / info.columns))
+                        continue;
+                    region[(size_t) next] = id;
+                    stack.push_back(next);
+                }
+            }
+            regions.push_back(box(info, members));
+        }
+        return regions;
+    }
+
+private:
+    const MapInfo *info;
+    SolverConfig config;
+
+    static Region box(const MapInfo &info, const vector<int> &members) {
+        int minX = info.columns, maxX = -1, minY = info.rows, maxY = -1;
+        for (const int &cell : members) {
+            minX = min(minX, cell % info.columns);
+            maxX = max(maxX, cell % info.columns);
+            minY = min(minY, cell / info.columns);
+            maxY = max(maxY, cell / info.columns);
+        }
+        Region region;
+        region.x = minX;
+        region.y = minY;
+        region.columns = maxX - minX + 1;
+        region.rows = maxY - minY + 1;
+        region.cells = (int) members.size();
+        int boxCells = region.columns * region.rows;
+        region.banned.assign(MapInfo::bitmapWords(boxCells), ~0ULL);
+        // bits past the box stay clear, same shapes give the same bitmap
+        if (boxCells % 64)
+            region.banned.back() = (1ULL << (boxCells % 64)) - 1;
+        for (const int &cell : members) {
+            int inBox = (cell / info.columns - minY) * region.columns + cell % info.columns - minX;
+            region.banned[(size_t) inBox / 64] &= ~(1ULL << (inBox % 64));
+        }
+        return region;
+    }
+
+    SolverResult solveBox(const Region &region, const SolverConfig &boxConfig, const int &rank, const int &procs) {
+        MapInfo box(region.rows, region.columns, info->i1, info->i2, info->c1, info->c2, info->cn,
+                    region.rows * region.columns - region.cells);
+        box.setBanned(region.banned);
+        ArrayMap empty(box.rows, box.columns, box.banned);
+        empty.setStart();
+        SolverResult result(empty);
+
+        // a small state space goes to profile dp on rank 0, faster than any split. Branch and bound
+        // over all ranks takes the rest and boxes whose states did not fit
+        size_t states = 0;
+        if (!useProfileDp(box, boxConfig) || !solveProfileDp(&box, boxConfig, result, states)) {
+            Solver solver(&box, boxConfig);
+            if (procs == 1)
+                solver.solveLocal();
+            else
+                solver.solve();
+            if (rank == 0) {
+                result = *solver.best;
+                optimal = optimal && solver.optimal;
+            }
+        }
+        // stopped before any solution, leaving every cell empty is one
+        if (rank == 0 && result.price == INT32_MIN) {
+            result = SolverResult(empty);
+            result.price = region.cells * info->cn;
+        }
+        return result;
+    }
+
+    // tiles of a solved box onto the board, ids from nextId on. Next free id is returned
+    int place(SolverResult &result, const SolverResult &solved, const Region &region, const int &nextId) const {
+        int last = nextId - 1;
+        for (int y = 0; y < region.rows; y++) {
+            for (int x = 0; x < region.columns; x++) {
+                int id = solved.map.getValue(x, y);
+                if (id <= 0)
+                    continue;
+                result.map.setValue(region.x + x, region.y + y, nextId - 1 + id);
+                last = std::max(last, nextId - 1 + id);
+            }
+        }
+        result.price += solved.price;
+        return last + 1;
+    }
+};
+
+#endif //MI_PDP_REGION_SOLVER_H
@@ -0,0 +1,60 @@
+#include <cstddef>
+
+#ifndef MI_PDP_SEARCH_STATS_H
+#define MI_PDP_SEARCH_STATS_H
+
+// build with -DMI_PDP_STATS=0 and counting compiles to nothing
+#ifndef MI_PDP_STATS
+#define MI_PDP_STATS 1
+#endif
+
+#if MI_PDP_STATS
+#define STATS(statement) statement
+#else
+#define STATS(statement)
+#endif
+
+// nodes by share of cells already decided, bucket i holds depths i/DEPTH_BUCKETS .. (i+1)/DEPTH_BUCKETS
+#define DEPTH_BUCKETS 10
+
+// counters of the search on one thread, summed over its tasks. All fields are long long so the
+// whole struct goes to MPI_Reduce as an array
+struct SearchStats {
+    long long nodes = 0;
+    long long prunes = 0;         // subtrees cut by the bound
+    long long remotePrunes = 0;   // ... of which only a bound found by another rank could cut
+    long long optimumCutoffs = 0; // subtrees left because the bound reached MapInfo::optimPrice
+    long long symmetryCuts = 0;   // subtrees left to a mirror or rotation of them
+    long long improvements = 0;   // better prices found
+    long long boundsReceived = 0;
+    long long ttProbes = 0;
+    long long ttHits = 0;         // frontiers already searched with price at least as good
+    long long depth[DEPTH_BUCKETS] = {};
+
+    static const int FIELDS = 9 + DEPTH_BUCKETS;
+
+    long long *data() {
+        return &nodes;
+    }
+
+    const long long *data() const {
+        return &nodes;
+    }
+
+    SearchStats &operator+=(const SearchStats &other) {
+        for (int i = 0; i < FIELDS; i++)
+            data()[i] += other.data()[i];
+        return *this;
+    }
+};
+
+static_assert(sizeof(SearchStats) == SearchStats::FIELDS * sizeof(long long), "SearchStats must be an array of counters");
+
+// one per OpenMP thread, padded so neighbours do not share a cache line
+struct ThreadStats {
+    SearchStats stats;
+    int nodesSinceCheck = 0; // nodes since the thread last looked at the clock
+    char padding[64];
+};
+
+#endif //MI_PDP_SEARCH_STATS_H
@@ -0,0 +1,1945 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <omp.h>
+#include <mpi.h>
+
+#include "map_info.h"
+#include "array_map.h"
+#include "bit_map.h"
+#include "solver_result.h"
+#include "search_stats.h"
+#include "transposition_table.h"
+#include "profile_solver.h"
+#include "subtree_estimator.h"
+#include "beam_search.h"
+#include "symmetry.h"
+#include "checkpoint.h"
+#include "tile_kernel.h"
+
+#ifndef MI_PDP_SOLVER_H
+#define MI_PDP_SOLVER_H
+
+using namespace std;
+
+#define TAG_WORK 1
+#define TAG_END 2
+#define TAG_DONE 3 // worker finished its tasks, results went before. Carries bound of what it left unexplored
+#define TAG_RESULT 4 // better solution, sent by worker whenever it has one
+#define TAG_STEAL 5
+#define TAG_STEAL_REPLY 6 // victim to master, carries the task given away
+#define TAG_BOUND 7 // better price found, workers send it to master, master to everyone else
+// explored weight of the tree, bound of the open nodes and, when checkpointing, the open nodes
+// packed as tasks, worker to master
+#define TAG_PROGRESS 8
+#define TAG_STOP 9 // master to workers -- time is up or the gap is small enough, leave the search
+
+// result message is version, price and packed map, bump on any change of the layout
+#define RESULT_VERSION 1
+
+// weight of the whole search tree, every node splits its weight evenly among its children
+#define TREE_WEIGHT (1LL << 62)
+
+#define WORKER_IDLE 0
+#define WORKER_BUSY 1
+#define WORKER_WAITING 2 // steal request for it is on the way
+
+// branches of one search node, in the order they are tried
+#define BRANCH_H_I2 0
+#define BRANCH_V_I2 1
+#define BRANCH_H_I1 2
+#define BRANCH_V_I1 3
+#define BRANCH_SKIP 4
+#define BRANCH_COUNT 5
+#define ALL_BRANCHES ((1 << BRANCH_COUNT) - 1)
+
+// COPY - every branch works on its own copy of ArrayMap (original solver)
+// IN_PLACE - one map per search, placements are rolled back via undo stack
+// BITBOARD - as IN_PLACE, but on BitMap; falls back to IN_PLACE for boards over 64x64
+enum class SearchMode {
+    COPY, IN_PLACE, BITBOARD
+};
+
+// FIXED - H I2, V I2, H I1, V I1, skip, as the original solver
+// RATIO - by price per covered cell, better tile first; same as FIXED when I2 pays more per cell
+enum class BranchOrder {
+    FIXED, RATIO
+};
+
+// BRANCH_AND_BOUND - Solver, distributed over all ranks
+// PROFILE_DP - ProfileSolver on rank 0, exact and fast for narrow boards
+// AUTO - PROFILE_DP when profile has at most dpBits bits, BRANCH_AND_BOUND otherwise.
+// PROFILE_DP gives way to BRANCH_AND_BOUND when its states would outgrow dpStates
+enum class Engine {
+    AUTO, BRANCH_AND_BOUND, PROFILE_DP
+};
+
+struct SolverConfig {
+    Engine engine = Engine::AUTO;
+    // widest profile AUTO hands to ProfileSolver, never above ProfileSolver::MAX_PROFILE
+    int dpBits = 40;
+    // links the profile dp may keep, 4 bytes each -- cells of the board times states per cell
+    long long dpStates = 1LL << 26;
+    SearchMode mode = SearchMode::BITBOARD;
+    // OpenMP threads per rank for in place modes, 0 = all available
+    int threads = 1;
+    // branches are spawned as tasks only above this depth...
+    int taskDepth = 6;
+    // ... and only while the subtree has more uncovered cells than this
+    int taskCells = 0;
+    // worker checks for steal requests every pollInterval search nodes
+    int pollInterval = 10000;
+    // nodes with fewer uncovered cells are not worth sending to another rank
+    int stealCells = 16;
+    // bound counts free cells no tile can reach any more as uncovered (bitboard only)
+    bool tightBound = true;
+    // transposition table of 2^ttBits frontiers (bitboard only), 0 = off
+    int ttBits = 20;
+    // frontiers with fewer uncovered cells are searched again rather than looked up
+    int ttCells = 12;
+    // seconds between progress lines of the master, 0 = off
+    double progressInterval = 10;
+    // most tasks master sends in one message while its queue is long
+    int taskBatch = 1;
+    // master splits the largest estimated task until there are this many per worker...
+    int tasksPerWorker = 4;
+    // ... and none is more than taskBalance times the average
+    double taskBalance = 2;
+    // random walks per subtree size estimate, 0 = split breadth first as before
+    int probes = 32;
+    // boards kept per cell by the beam search for the starting incumbent, 0 = start from nothing
+    int beamWidth = 256;
+    BranchOrder order = BranchOrder::RATIO;
+    // boards with the cursor in this many top rows are cut unless they lead their images under
+    // mirrors and rotations of the board, the transposition table starts below them. 0 = off
+    int symmetryRows = 2;
+    // anytime mode -- seconds until the best solution so far is returned, 0 = search to the end
+    double timeLimit = 0;
+    // ... or stop once (upper bound - best) / |upper bound| is at most this, 0 = off.
+    // Open nodes are known from serial workers only, their progress messages carry the bound
+    double gap = 0;
+    // master writes the best solution and all work not finished yet to this file...
+    string checkpointFile;
+    // ... every this many seconds. Open nodes of workers come with their progress messages
+    double checkpointInterval = 60;
+    // start from a checkpoint instead of preparing tasks
+    string resumeFile;
+    // in place search compiled for the tiles of the instance when there is one, see TileKernel
+    bool tileKernels = true;
+    // rank 0 searches tasks of the queue as well and serves workers between its nodes (in place
+    // modes only). Its threads need MPI_THREAD_FUNNELED, only the main one talks to workers
+    bool masterSearch = true;
+    // banned cells that cut the board into parts no tile spans get each part solved on its own,
+    // see RegionSolver. Not with checkpoints, those hold a single search
+    bool regions = true;
+};
+
+// search node with branches left to explore, kept for work donation
+struct Frame {
+    int x, y;
+    int price;
+    int uncovered;
+    size_t undoSize; // moves on the board when the node was entered
+    int branch;      // branch being explored
+    int done;        // branches finished before it
+    int branches;    // branches still to be explored here
+    int valid;       // branches that can be placed, children split the weight
+    long long weight; // share of TREE_WEIGHT under this node
+    int next;         // place in order of the branch to try after the current one
+};
+
+// ------------------------------------------------------------------------------------------------------------------
+
+
+class QueueItem {
+public:
+    ArrayMap map;
+    int price;
+    int uncovered;
+    int branches;
+    long long weight;
+
+    QueueItem() {
+
+    }
+
+    QueueItem(const ArrayMap &map, int price, int uncovered, long long weight, int branches = ALL_BRANCHES)
+            : map(map), price(price), uncovered(uncovered), branches(branches), weight(weight) {
+
+    }
+
+    // member by member, ArrayMap copies its cells itself
+    QueueItem(const QueueItem &copy) = default;
+
+    QueueItem &operator=(const QueueItem &copy) = default;
+
+    // price + uncovered + bestPrice + branches + weight in two halves + packed map
+    static int packedSize(const int &maxTiles) {
+        return 6 + ArrayMap::packedSize(maxTiles);
+    }
+
+    int pack(int *buffer, const int &bestPrice) const {
+        buffer[0] = price;
+        buffer[1] = uncovered;
+        buffer[2] = bestPrice;
+        buffer[3] = branches;
+        buffer[4] = (int) (weight >> 32);
+        buffer[5] = (int) (weight & 0xFFFFFFFFLL);
+        return 6 + map.pack(buffer + 6);
+    }
+
+    int unpack(const int *buffer, const ArrayMap &start, int &bestPrice) {
+        price = buffer[0];
+        uncovered = buffer[1];
+        bestPrice = buffer[2];
+        branches = buffer[3];
+        weight = ((long long) buffer[4] << 32) | (unsigned int) buffer[5];
+        return 6 + map.unpack(buffer + 6, start);
+    }
+
+    static int packedLength(const int *buffer) {
+        return 6 + ArrayMap::packedLength(buffer + 6);
+    }
+};
+
+// Tasks kept as QueueItem::pack() lays them out -- header, cursor and the tiles placed from the
+// root, no board. All of them share one arena, a task takes 9 ints and one per tile instead of
+// a whole ArrayMap. Boards are rebuilt on top of the empty one only when the master needs them,
+// tasks for workers are copied out as they are and replayed there
+class TaskQueue {
+public:
+    size_t size() const {
+        return offsets.size();
+    }
+
+    bool empty() const {
+        return offsets.empty();
+    }
+
+    void clear() {
+        offsets.clear();
+        arena.clear();
+        live = 0;
+    }
+
+    void push_back(const QueueItem &task) {
+        offsets.push_back(append(task));
+    }
+
+    void push_front(const QueueItem &task) {
+        offsets.push_front(append(task));
+    }
+
+    // packed task as it came in a message or a checkpoint, returns the ints it took there
+    int push_back(const int *packed) {
+        offsets.push_back(append(packed));
+        return QueueItem::packedLength(packed);
+    }
+
+    int push_front(const int *packed) {
+        offsets.push_front(append(packed));
+        return QueueItem::packedLength(packed);
+    }
+
+    void pop_front() {
+        live -= (size_t) QueueItem::packedLength(packed(0));
+        offsets.pop_front();
+        // space of popped tasks is reused once it is most of the arena
+        if (offsets.empty())
+            clear();
+        else if (live < arena.size() / 2)
+            compact();
+    }
+
+    const int *packed(const size_t &i) const {
+        return arena.data() + offsets[i];
+    }
+
+    // board rebuilt on top of start, the map with banned cells only
+    QueueItem get(const size_t &i, const ArrayMap &start) const {
+        QueueItem task;
+        int bestPrice;
+        task.unpack(packed(i), start, bestPrice);
+        return task;
+    }
+
+    QueueItem front(const ArrayMap &start) const {
+        return get(0, start);
+    }
+
+    // best price any task can still reach
+    int bound(const MapInfo &info) const {
+        int result = INT32_MIN;
+        for (size_t i = 0; i < offsets.size(); i++)
+            result = std::max(result, bound(i, info));
+        return result;
+    }
+
+    int bound(const size_t &i, const MapInfo &info) const {
+        return packed(i)[0] + info.getUpperPrice(packed(i)[1]);
+    }
+
+    // task i into buffer as a work message carries it, returns its size
+    int pack(const size_t &i, int *buffer, const int &bestPrice) const {
+        int length = QueueItem::packedLength(packed(i));
+        copy_n(packed(i), length, buffer);
+        buffer[2] = bestPrice;
+        return length;
+    }
+
+    // all tasks in order appended to buffer
+    void pack(vector<int> &buffer, const int &bestPrice) const {
+        for (size_t i = 0; i < offsets.size(); i++) {
+            size_t start = buffer.size();
+            buffer.resize(start + (size_t) QueueItem::packedLength(packed(i)));
+            pack(i, buffer.data() + start, bestPrice);
+        }
+    }
+
+    // bytes held by the arena and the offsets, for the log
+    size_t bytes() const {
+        return arena.capacity() * sizeof(int) + offsets.size() * sizeof(size_t);
+    }
+
+private:
+    vector<int> arena;
+    deque<size_t> offsets;
+    size_t live = 0; // ints of tasks still in the queue
+
+    size_t append(const QueueItem &task) {
+        size_t offset = arena.size();
+        arena.resize(offset + (size_t) QueueItem::packedSize(task.map.nextId - 1));
+        task.pack(arena.data() + offset, 0);
+        live += arena.size() - offset;
+        return offset;
+    }
+
+    size_t append(const int *packed) {
+        size_t offset = arena.size();
+        arena.insert(arena.end(), packed, packed + QueueItem::packedLength(packed));
+        live += arena.size() - offset;
+        return offset;
+    }
+
+    void compact() {
+        vector<int> tasks;
+        tasks.reserve(live);
+        for (size_t &offset : offsets) {
+            const int *task = arena.data() + offset;
+            offset = tasks.size();
+            tasks.insert(tasks.end(), task, task + QueueItem::packedLength(task));
+        }
+        arena.swap(tasks);
+    }
+};
+
+// ------------------------------------------------------------------------------------------------------------------
+class Solver {
+public:
+    SolverResult *best;
+    SearchStats stats;   // this rank, summed over its threads
+    SearchStats summary; // all ranks, on rank 0 only
+    // rank 0 -- no solution can beat upperBound, optimal when best reached it
+    int upperBound;
+    bool optimal;
+
+    Solver(MapInfo *mapInfo, const SolverConfig &config = SolverConfig())
+            : best(nullptr), upperBound(INT32_MAX), optimal(false), info(mapInfo), config(config), rank(0),
+              lastVictim(0), taskMap(nullptr), bestPrice(INT32_MIN),
+              nodesSincePoll(0), localBound(INT32_MIN), remoteBound(INT32_MIN), startTime(0), lastProgress(0),
+              doneWeight(0), taskWeight(0), donatedWeight(0), sentPrice(INT32_MIN), symmetry(mapInfo),
+              stopping(false), stopBound(INT32_MIN), taskBound(INT32_MIN), lastCheckpoint(0), resumedWeight(0),
+              pendingOffset(0), pendingSize(0), pendingCount(0), currentTask(nullptr), masterSearching(false) {
+        if (config.mode == SearchMode::BITBOARD && !BitMap::fits(info->columns, max(info->i1, info->i2)))
+            this->config.mode = SearchMode::IN_PLACE;
+        if (this->config.threads <= 0)
+            this->config.threads = omp_get_max_threads();
+        // copy search has no hook to serve workers from
+        int level;
+        MPI_Query_thread(&level);
+        if (this->config.mode == SearchMode::COPY || (this->config.threads > 1 && level < MPI_THREAD_FUNNELED))
+            this->config.masterSearch = false;
+        if (symmetry.empty())
+            this->config.symmetryRows = 0;
+        if (this->config.mode == SearchMode::BITBOARD && this->config.ttBits > 0)
+            table.reset(new TranspositionTable(this->config.ttBits, info->rows, info->columns,
+                                               max(info->i1, info->i2)));
+        threadStats.resize((size_t) this->config.threads);
+        emptyMap = ArrayMap(info->rows, info->columns, info->banned);
+
+        // largest message is a full batch of tasks or a result with every cell covered by tiles
+        int maxTiles = info->startUncovered / min(info->i1, info->i2);
+        int messageSize = std::max(std::max(1 + this->config.taskBatch * QueueItem::packedSize(maxTiles),
+                                            3 + QueueItem::packedSize(maxTiles)),
+                                   2 + ArrayMap::packedSize(maxTiles));
+        sendBuffer.resize((size_t) std::max(messageSize, 3));
+        receiveBuffer.resize(sendBuffer.size());
+        for (int uncovered = 0; uncovered <= info->startUncovered; uncovered++)
+            depthBucket.push_back((info->startUncovered - uncovered) * DEPTH_BUCKETS / (info->startUncovered + 1));
+        orderBranches();
+    }
+
+    void solve() {
+
+        int proc_num, num_procs;
+        MPI_Comm_rank(MPI_COMM_WORLD, &proc_num);
+        MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+        rank = proc_num;
+        startTime = MPI_Wtime();
+        lastProgress = startTime;
+
+        // MASTER
+        if (proc_num == 0) {
+            master(num_procs);
+            // as master, no more work, all slaves done. Finish result.
+            FindLeftEmptyTiles();
+
+        } else { //SLAVE
+            slave(proc_num);
+        }
+
+        STATS(reportStats());
+    }
+
+    // whole instance on this rank without any messages, for instances too small to split.
+    // Threads of the rank still share the search
+    void solveLocal() {
+        startTime = MPI_Wtime();
+        lastProgress = startTime;
+        ArrayMap map(info->rows, info->columns, info->banned);
+        map.setStart();
+        best = new SolverResult(map);
+        if (config.beamWidth > 0) {
+            BeamSearch beam(info, config.beamWidth);
+            *best = beam.solve(map);
+        }
+        if (best->price < info->optimPrice)
+            startSolve(&map, 0, info->startUncovered);
+        // stopped by the clock, open nodes are not bounded here -- the empty board bound stands for them
+        upperBound = stopping ? std::max(best->price, info->optimPrice) : best->price;
+        optimal = upperBound <= best->price;
+        for (const ThreadStats &thread : threadStats)
+            stats += thread.stats;
+        FindLeftEmptyTiles();
+    }
+
+    ~Solver() {
+        delete best;
+    }
+
+private:
+    MapInfo *info;
+    SolverConfig config;
+    int rank;
+    TaskQueue dataQueue;
+    // master side of work stealing
+    vector<int> workerState;
+    vector<int> stealIds;     // id of the last steal request made for the worker
+    vector<bool> stealPending; // worker was asked for work and did not answer yet
+    int lastVictim;
+    const ArrayMap *taskMap; // map the in place search started from
+    // pruning bound of in place search, read without locking by all threads.
+    // best->map follows it, written only by the thread that raised the price
+    atomic<int> bestPrice;
+    // open nodes of the serial search on a worker, shallowest first
+    vector<Frame> frames;
+    int nodesSincePoll;
+    // bound this rank would have without bounds of the others, tells remote prunes apart
+    int localBound;
+    // best price heard of from other ranks
+    int remoteBound;
+    // frontiers searched by this rank, shared by its threads and kept over tasks
+    unique_ptr<TranspositionTable> table;
+    // non-blocking bound messages in flight, deque keeps the sent values in place
+    deque<int> boundValues;
+    vector<MPI_Request> boundRequests;
+    // counters of the threads of this rank, summed into stats when the rank is done
+    vector<ThreadStats> threadStats;
+    vector<int> depthBucket; // histogram bucket by uncovered cells
+    int order[BRANCH_COUNT]; // branches in the order a node tries them
+    double startTime;
+    double lastProgress;
+    // progress -- weight of the tree finished by this rank, of the current task and given away from it
+    long long doneWeight;
+    long long taskWeight;
+    long long donatedWeight;
+    vector<long long> workerDone;           // master: last doneWeight reported by each worker
+    // board with banned cells only, packed maps are replayed on top of it
+    ArrayMap emptyMap;
+    // work and result messages are packed here, allocated once for the largest one
+    vector<int> sendBuffer;
+    vector<int> receiveBuffer;
+    // worker: best price the master already has from us or gave us
+    int sentPrice;
+    vector<pair<double, int>> improvementLog; // master: seconds from start and the better price
+    Symmetry symmetry;
+    // anytime mode -- search is being left, unexplored work bounded by stopBound.
+    // Master sums up the bounds of workers, each worker those of its open nodes and skipped tasks
+    atomic<bool> stopping;
+    int stopBound;
+    int taskBound;                  // worker: bound of the whole current task
+    vector<int> workerBound;        // master: bound of the open nodes of each worker
+    // master: work of each worker as far as it knows -- tasks sent or stolen, later open nodes
+    // from its progress. May overlap what is already done, never misses anything
+    vector<TaskQueue> workerTasks;
+    double lastCheckpoint;
+    long long resumedWeight; // explored before the run resumed from a checkpoint
+    // worker: tasks of the batch not started yet, packed in receiveBuffer
+    int pendingOffset, pendingSize, pendingCount;
+    const QueueItem *currentTask;
+    vector<int> progressBuffer;
+    // master is in a task of its own, workers are served from inside the search
+    bool masterSearching;
+
+    // better price per covered cell first, ties keep the fixed order
+    void orderBranches() {
+        double perCell[BRANCH_COUNT] = {(double) info->c2 / info->i2, (double) info->c2 / info->i2,
+                                        (double) info->c1 / info->i1, (double) info->c1 / info->i1,
+                                        (double) info->cn};
+        for (int branch = 0; branch < BRANCH_COUNT; branch++)
+            order[branch] = branch;
+        if (config.order == BranchOrder::RATIO)
+            stable_sort(order, order + BRANCH_COUNT, [&perCell](const int &a, const int &b) {
+                return perCell[a] > perCell[b];
+            });
+    }
+
+    ThreadStats &thread() {
+        return threadStats[config.threads > 1 ? (size_t) omp_get_thread_num() : 0];
+    }
+
+    SearchStats &counters() {
+        return thread().stats;
+    }
+
+    // sum the threads, gather all ranks on rank 0 and print what the search did
+    void reportStats() {
+        stats = SearchStats();
+        for (const ThreadStats &thread : threadStats)
+            stats += thread.stats;
+        if (rank != 0)
+            cout << "SLAVE:= " << rank << " - nodes: " << stats.nodes << ", pruned: " << stats.prunes
+                 << ", bounds received: " << stats.boundsReceived
+                 << ", pruned only thanks to them: " << stats.remotePrunes
+                 << ", tt probes: " << stats.ttProbes << ", tt hits: " << stats.ttHits << endl;
+        MPI_Reduce(stats.data(), summary.data(), SearchStats::FIELDS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        if (rank != 0)
+            return;
+
+        cout << "MASTER -- summary: nodes: " << summary.nodes << ", pruned: " << summary.prunes
+             << ", pruned only thanks to remote bounds: " << summary.remotePrunes
+             << ", optimum cutoffs: " << summary.optimumCutoffs << ", symmetry cuts: " << summary.symmetryCuts
+             << ", improvements: " << summary.improvements
+             << ", bounds received: " << summary.boundsReceived
+             << ", tt probes: " << summary.ttProbes << ", tt hits: " << summary.ttHits << endl;
+        cout << "MASTER -- nodes by cells decided:";
+        for (int i = 0; i < DEPTH_BUCKETS; i++)
+            cout << " " << i * 100 / DEPTH_BUCKETS << "%: " << summary.depth[i];
+        cout << endl;
+        cout << "MASTER -- best price over time:";
+        for (const auto &improvement : improvementLog)
+            cout << " " << improvement.second << " at " << improvement.first << " s";
+        cout << endl;
+    }
+
+    void noteImprovement(const int &price) {
+        if (improvementLog.empty() || price > improvementLog.back().second)
+            improvementLog.emplace_back(MPI_Wtime() - startTime, price);
+    }
+
+    // finished share of the current task -- branches done in every open node
+    long long openWeight() const {
+        long long weight = 0;
+        for (const Frame &frame : frames) {
+            weight += frame.weight / __builtin_popcount(frame.valid) * __builtin_popcount(frame.done);
+        }
+        return weight;
+    }
+
+    // open work packed by packOpenWork() goes along, count -1 when there is none
+    void sendProgress(const long long &weight, const int &bound, const int &count = -1) {
+        if (count <= 0)
+            progressBuffer.resize(4);
+        progressBuffer[0] = (int) (weight >> 32);
+        progressBuffer[1] = (int) (weight & 0xFFFFFFFFLL);
+        progressBuffer[2] = bound;
+        progressBuffer[3] = count;
+        MPI_Send(progressBuffer.data(), (int) progressBuffer.size(), MPI_INT, 0, TAG_PROGRESS, MPI_COMM_WORLD);
+        lastProgress = MPI_Wtime();
+    }
+
+    // branches of a frame not searched yet. The deepest frame holds the node being searched,
+    // the one below it covers the rest of the branch it is in
+    int openBranches(const size_t &frame) const {
+        int rest = frames[frame].branches & frames[frame].valid & ~frames[frame].done;
+        if (frame + 1 < frames.size())
+            rest &= ~(1 << frames[frame].branch);
+        return rest;
+    }
+
+    // best price any open node of the serial search can still reach
+    int openBound() const {
+        if (frames.empty())
+            return taskBound;
+        int bound = INT32_MIN;
+        for (size_t frame = 0; frame < frames.size(); frame++) {
+            int rest = openBranches(frame);
+            for (int branch = 0; branch < BRANCH_COUNT; branch++) {
+                if (rest & (1 << branch))
+                    bound = std::max(bound, childBound(frames[frame], branch));
+            }
+        }
+        return bound;
+    }
+
+    // open nodes of the current task and the rest of the batch as tasks into progressBuffer
+    template<class Board>
+    int packOpenWork(const Board &map, const vector<Move> &undo) {
+        progressBuffer.resize(4);
+        int count = 0;
+        int size = QueueItem::packedSize(info->startUncovered / min(info->i1, info->i2));
+        for (size_t frame = 0; frame < frames.size(); frame++) {
+            int rest = openBranches(frame);
+            if (rest == 0)
+                continue;
+            const Frame &open = frames[frame];
+            long long weight = open.weight / __builtin_popcount(open.valid) * __builtin_popcount(rest);
+            QueueItem task(snapshot(map, undo, open), open.price, open.uncovered, weight, rest);
+            size_t start = progressBuffer.size();
+            progressBuffer.resize(start + (size_t) size);
+            progressBuffer.resize(start + (size_t) task.pack(progressBuffer.data() + start, bestPrice.load()));
+            count++;
+        }
+        if (frames.empty() && currentTask) {
+            size_t start = progressBuffer.size();
+            progressBuffer.resize(start + (size_t) size);
+            progressBuffer.resize(start + (size_t) currentTask->pack(progressBuffer.data() + start, bestPrice.load()));
+            count++;
+        }
+        progressBuffer.insert(progressBuffer.end(), receiveBuffer.begin() + pendingOffset,
+                              receiveBuffer.begin() + pendingOffset + pendingSize);
+        return count + pendingCount;
+    }
+
+    int childBound(const Frame &frame, const int &branch) const {
+        switch (branch) {
+            case BRANCH_H_I2:
+            case BRANCH_V_I2:
+                return frame.price + info->c2 + info->getUpperPrice(frame.uncovered - info->i2);
+            case BRANCH_H_I1:
+            case BRANCH_V_I1:
+                return frame.price + info->c1 + info->getUpperPrice(frame.uncovered - info->i1);
+            default:
+                return frame.price + info->cn + info->getUpperPrice(frame.uncovered - 1);
+        }
+    }
+
+    bool timeUp() const {
+        return config.timeLimit > 0 && MPI_Wtime() - startTime >= config.timeLimit;
+    }
+
+    void master(const int & num_procs) {
+        // prepare map
+        ArrayMap map(info->rows, info->columns, info->banned);
+        map.setStart();
+        best = new SolverResult(map);
+        if (config.symmetryRows > 0) {
+            cout << "MASTER - symmetries:";
+            for (const string &name : symmetry.names())
+                cout << " " << name;
+            cout << endl;
+        }
+        // tasks of a checkpoint replace the beam and the preparation
+        bool resumed = !config.resumeFile.empty() && resume();
+        if (!resumed && config.beamWidth > 0) {
+            BeamSearch beam(info, config.beamWidth);
+            *best = beam.solve(map);
+            cout << "MASTER - beam incumbent " << best->price << " of at most " << info->optimPrice << ", "
+                 << beam.states << " boards, " << MPI_Wtime() - startTime << " s" << endl;
+            STATS(noteImprovement(best->price));
+        }
+        int workers = num_procs - 1;
+        if (!resumed) {
+            cout << "MASTER - prepare data bfs" << endl;
+            // enough tasks to start every worker and the master - stealing balances the rest
+            int searchers = workers + (config.masterSearch ? 1 : 0);
+            const unsigned int max = std::max(8u, (unsigned int) (config.tasksPerWorker * searchers));
+            if (config.probes > 0)
+                prepare_estimated_tasks(map, max);
+            else
+                prepare_tasks(map, max);
+        }
+        // workers would cut every task right away
+        if (best->price == info->optimPrice)
+            dataQueue.clear();
+
+        workerState.assign(num_procs, WORKER_IDLE);
+        stealIds.assign(num_procs, 0);
+        stealPending.assign(num_procs, false);
+        lastVictim = 0;
+        workerDone.assign(num_procs, 0);
+        workerBound.assign(num_procs, INT32_MIN);
+        workerTasks.assign(num_procs, TaskQueue());
+        lastCheckpoint = MPI_Wtime();
+
+        // initial send of work
+        cout << "MASTER - initial-send-to-work, workers" << workers << ", works to do: " << dataQueue.size()
+             << ", " << dataQueue.bytes() << " bytes" << endl;
+        for (int workerId = 1; workerId <= workers; workerId++)
+            assignWork(workerId);
+
+        while (true) {
+            if (!config.checkpointFile.empty() && !stopping
+                && MPI_Wtime() - lastCheckpoint >= config.checkpointInterval)
+                writeCheckpoint();
+            // master searches too whenever no message waits -- a task of the queue, or it steals one
+            bool own = config.masterSearch && !stopping;
+            if (own && workerState[0] == WORKER_IDLE && !messageWaiting()) {
+                if (!dataQueue.empty()) {
+                    searchTask();
+                    continue;
+                }
+                if (workersActive())
+                    assignWork(0);
+            }
+            if (!workersActive() && (!own || dataQueue.empty()))
+                break;
+            if (config.timeLimit > 0 && !stopping)
+                waitForMessage();
+            handleMessage(receive()); // wait for result from some slave
+        }
+
+        upperBound = stopping ? std::max(best->price, stopBound) : best->price;
+        optimal = upperBound <= best->price || best->price == info->optimPrice;
+        if (stopping)
+            cout << "MASTER -- stopped after " << MPI_Wtime() - startTime << " s, best " << best->price
+                 << ", upper bound " << upperBound << (optimal ? ", optimal" : ", not proven optimal") << endl;
+        // finished run leaves a checkpoint without tasks, resuming it only prints the result
+        else if (!config.checkpointFile.empty())
+            writeCheckpoint();
+
+        // no more work -- finish
+        finishBounds();
+        for (int workerId = 1; workerId <= workers; workerId++) {
+            int dummy = 1;
+            MPI_Send(&dummy, 1, MPI_INT, workerId, TAG_END, MPI_COMM_WORLD);
+        }
+
+        cout << "MASTER -- routine quit" << endl;
+    }
+
+    // master: one message of a worker, from the loop of master() or from inside its own search
+    void handleMessage(const MPI_Status &status) {
+        vector<int> &buffer = receiveBuffer;
+        if (status.MPI_TAG == TAG_PROGRESS) {
+            workerDone[status.MPI_SOURCE] = ((long long) buffer[0] << 32) | (unsigned int) buffer[1];
+            workerBound[status.MPI_SOURCE] = buffer[2];
+            // open nodes and tasks not started yet replace what the worker had
+            if (buffer[3] >= 0) {
+                TaskQueue &tasks = workerTasks[status.MPI_SOURCE];
+                tasks.clear();
+                int offset = 4;
+                for (int i = 0; i < buffer[3]; i++)
+                    offset += tasks.push_back(buffer.data() + offset);
+            }
+            if (MPI_Wtime() - lastProgress >= config.progressInterval)
+                printProgress();
+            checkGap();
+            return;
+        }
+
+        if (status.MPI_TAG == TAG_BOUND) {
+            relayBound(buffer[0], status.MPI_SOURCE);
+            return;
+        }
+
+        if (status.MPI_TAG == TAG_RESULT) {
+            if (buffer[0] != RESULT_VERSION) {
+                cout << "MASTER -- result of version " << buffer[0] << " from " << status.MPI_SOURCE
+                     << " ignored" << endl;
+                return;
+            }
+            // results of tasks sent out earlier can be worse than what already came back.
+            // Threads of the master's own search may be storing theirs
+            int bestPriceUpdate = buffer[1];
+            #pragma omp critical(best_map)
+            {
+                if (bestPriceUpdate > best->price) {
+                    best->map.unpack(buffer.data() + 2, emptyMap);
+                    best->price = bestPriceUpdate;
+                }
+            }
+            STATS(noteImprovement(bestPriceUpdate));
+            // threads of a worker do not send bounds, the result is the first the others hear of it
+            relayBound(bestPriceUpdate, status.MPI_SOURCE);
+            return;
+        }
+
+        // task a worker gave to the master, it goes through the queue like any other
+        if (status.MPI_TAG == TAG_WORK) {
+            dataQueue.push_front(buffer.data() + 1);
+            return;
+        }
+
+        if (status.MPI_TAG == TAG_STEAL_REPLY) {
+            int workers = (int) workerState.size() - 1;
+            int thief = buffer[0];
+            stealPending[status.MPI_SOURCE] = false;
+            // replies to older requests are stale - thief already finished the stolen work
+            if (workerState[thief] == WORKER_WAITING && stealIds[thief] == buffer[1]) {
+                if (buffer[2] && thief == 0) {
+                    // master has the task in its queue already, the work came first
+                    workerState[0] = WORKER_IDLE;
+                } else if (buffer[2]) {
+                    workerState[thief] = WORKER_BUSY;
+                    workerTasks[thief].clear();
+                    workerTasks[thief].push_back(buffer.data() + 3);
+                    // part of the victim's work, its next progress tells better
+                    workerBound[thief] = workerBound[status.MPI_SOURCE];
+                } else {
+                    assignWork(thief);
+                }
+            }
+            // victim can be asked again, maybe the thief became one as well
+            for (int workerId = 1; workerId <= workers; workerId++) {
+                if (workerState[workerId] == WORKER_IDLE)
+                    assignWork(workerId);
+            }
+            return;
+        }
+
+        // TAG_DONE, worker that had to stop tells what it left
+        stopBound = std::max(stopBound, buffer[0]);
+        workerBound[status.MPI_SOURCE] = INT32_MIN;
+        workerTasks[status.MPI_SOURCE].clear();
+        if (buffer[0] != INT32_MIN && !stopping)
+            stop("time limit reached");
+        assignWork(status.MPI_SOURCE);
+        checkGap();
+    }
+
+    // master: sleep until a message comes or the time is up
+    void waitForMessage() {
+        int flag;
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+        while (!flag) {
+            if (timeUp()) {
+                stop("time limit reached");
+                return;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+            MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+        }
+    }
+
+    bool messageWaiting() const {
+        int flag;
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+        return flag != 0;
+    }
+
+    // master: next task of the queue searched on this rank, as a worker would
+    void searchTask() {
+        QueueItem task = dataQueue.front(emptyMap);
+        workerTasks[0].clear();
+        workerTasks[0].push_back(dataQueue.packed(0));
+        dataQueue.pop_front();
+        workerState[0] = WORKER_BUSY;
+        taskWeight = task.weight;
+        donatedWeight = 0;
+        taskBound = task.price + info->getUpperPrice(task.uncovered);
+        workerBound[0] = taskBound;
+
+        masterSearching = true;
+        startSolve(&task.map, task.price, task.uncovered, task.branches, std::max(best->price, remoteBound));
+        masterSearching = false;
+
+        // serve() put the open nodes into stopBound when it stopped
+        if (!stopping)
+            doneWeight += taskWeight - donatedWeight;
+        workerDone[0] = doneWeight;
+        relayBound(best->price, 0);
+        workerState[0] = WORKER_IDLE;
+        workerTasks[0].clear();
+        workerBound[0] = INT32_MIN;
+    }
+
+    // master: called by its own search every pollInterval nodes, from the main thread only.
+    // Handles what workers sent meanwhile, relays better prices of the search and gives idle
+    // workers open branches of it when the queue is empty
+    template<class Board>
+    void serve(const Board &map, const vector<Move> &undo) {
+        relayBound(bestPrice.load(), 0);
+        while (messageWaiting())
+            handleMessage(receive());
+
+        for (int workerId = 1; workerId < (int) workerState.size() && !stopping; workerId++) {
+            if (workerState[workerId] != WORKER_IDLE)
+                continue;
+            QueueItem task;
+            if (dataQueue.empty()) {
+                if (!donate(map, undo, task))
+                    break;
+                dataQueue.push_back(task);
+            }
+            assignWork(workerId);
+        }
+
+        workerBound[0] = openBound();
+        if (config.progressInterval > 0 && MPI_Wtime() - lastProgress >= config.progressInterval)
+            printProgress();
+        if (!stopping && timeUp())
+            stop("time limit reached");
+        checkGap();
+        if (!config.checkpointFile.empty() && !stopping
+            && MPI_Wtime() - lastCheckpoint >= config.checkpointInterval)
+            writeCheckpoint();
+        // open nodes are gone once the search unwinds
+        if (stopping)
+            stopBound = std::max(stopBound, openBound());
+    }
+
+    // master: no more work goes out, workers leave what they search and report its bound
+    void stop(const string &reason) {
+        stopping = true;
+        stopBound = std::max(stopBound, dataQueue.bound(*info));
+        dataQueue.clear();
+        cout << "MASTER -- " << reason << ", stopping workers" << endl;
+        for (int workerId = 1; workerId < (int) workerState.size(); workerId++) {
+            int dummy = 1;
+            MPI_Send(&dummy, 1, MPI_INT, workerId, TAG_STOP, MPI_COMM_WORLD);
+        }
+    }
+
+    // master: upper bound of everything not searched yet -- queue and open nodes of busy workers
+    // and of the master's own search
+    int frontierBound() const {
+        int bound = std::max(std::max(best->price, remoteBound), dataQueue.bound(*info));
+        for (size_t workerId = 0; workerId < workerState.size(); workerId++) {
+            if (workerState[workerId] != WORKER_IDLE)
+                bound = std::max(bound, workerBound[workerId]);
+        }
+        return bound;
+    }
+
+    void checkGap() {
+        if (config.gap <= 0 || stopping)
+            return;
+        int upper = frontierBound();
+        int price = std::max(best->price, remoteBound);
+        if (upper - price <= config.gap * std::abs(upper))
+            stop("gap " + to_string(upper - price) + " to upper bound " + to_string(upper) + " reached");
+    }
+
+    // message of any size from anyone, receiveBuffer grows when it is too small
+    MPI_Status receive() {
+        MPI_Status status;
+        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        int count;
+        MPI_Get_count(&status, MPI_INT, &count);
+        if ((size_t) count > receiveBuffer.size())
+            receiveBuffer.resize((size_t) count);
+        MPI_Recv(receiveBuffer.data(), count, MPI_INT, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, &status);
+        return status;
+    }
+
+    // better price from a worker goes to all the others
+    void relayBound(const int &price, const int &source) {
+        if (price <= remoteBound)
+            return;
+
+        remoteBound = price;
+        STATS(noteImprovement(remoteBound));
+        // own search of the master prunes with it as well
+        int current = bestPrice.load();
+        while (price > current && !bestPrice.compare_exchange_weak(current, price));
+        for (int workerId = 1; workerId < (int) workerState.size(); workerId++) {
+            if (workerId != source)
+                sendBound(workerId, remoteBound);
+        }
+        // nobody can do better, rest of the queue would be cut right away
+        if (remoteBound == info->optimPrice)
+            dataQueue.clear();
+    }
+
+    // master: best solution, queue and the work of every worker to config.checkpointFile
+    void writeCheckpoint() {
+        Checkpoint checkpoint;
+        int tiles = info->startUncovered / min(info->i1, info->i2);
+        checkpoint.bestMap.resize((size_t) ArrayMap::packedSize(tiles));
+        // threads of the master's own search may be storing a better solution meanwhile
+        #pragma omp critical(best_map)
+        {
+            checkpoint.bestPrice = best->price;
+            checkpoint.bestMap.resize((size_t) best->map.pack(checkpoint.bestMap.data()));
+        }
+        checkpoint.explored = resumedWeight;
+        for (const long long &weight : workerDone)
+            checkpoint.explored += weight;
+
+        dataQueue.pack(checkpoint.tasks, checkpoint.bestPrice);
+        checkpoint.taskCount = (int) dataQueue.size();
+        for (const TaskQueue &tasks : workerTasks) {
+            tasks.pack(checkpoint.tasks, checkpoint.bestPrice);
+            checkpoint.taskCount += (int) tasks.size();
+        }
+
+        if (checkpoint.write(config.checkpointFile, *info))
+            cout << "MASTER - checkpoint of " << checkpoint.taskCount << " tasks to " << config.checkpointFile << endl;
+        else
+            cout << "MASTER - writing checkpoint " << config.checkpointFile << " failed" << endl;
+        lastCheckpoint = MPI_Wtime();
+    }
+
+    // master: best solution and tasks from config.resumeFile, false when it does not fit
+    bool resume() {
+        Checkpoint checkpoint;
+        if (!checkpoint.read(config.resumeFile, *info)) {
+            cout << "MASTER - cannot resume from " << config.resumeFile << ", starting over" << endl;
+            return false;
+        }
+        if (!checkpoint.bestMap.empty()) {
+            best->map.unpack(checkpoint.bestMap.data(), emptyMap);
+            best->price = checkpoint.bestPrice;
+            STATS(noteImprovement(best->price));
+        }
+        int offset = 0;
+        for (int i = 0; i < checkpoint.taskCount; i++)
+            offset += dataQueue.push_back(checkpoint.tasks.data() + offset);
+        resumedWeight = checkpoint.explored;
+        cout << "MASTER - resumed from " << config.resumeFile << ", best " << best->price << ", "
+             << dataQueue.size() << " tasks, " << (double) checkpoint.explored * 100.0 / (double) TREE_WEIGHT
+             << "% of tree explored" << endl;
+        return true;
+    }
+
+    // explored share of the tree as reported by workers, tasks still in queue count as unexplored
+    void printProgress() {
+        long long done = resumedWeight;
+        for (const long long &weight : workerDone)
+            done += weight;
+        double now = MPI_Wtime();
+        cout << "MASTER -- progress: " << (double) done * 100.0 / (double) TREE_WEIGHT << "% of tree explored, best "
+             << std::max(best->price, remoteBound) << ", " << now - startTime << " s" << endl;
+        lastProgress = now;
+    }
+
+    // next task from queue, otherwise ask some busy worker to share its work
+    void assignWork(const int &workerId) {
+        int workers = (int) workerState.size() - 1;
+        if (stopping) {
+            workerState[workerId] = WORKER_IDLE;
+            return;
+        }
+        // master takes its tasks from the queue itself
+        if (!dataQueue.empty() && workerId == 0) {
+            workerState[0] = WORKER_IDLE;
+            return;
+        }
+        if (!dataQueue.empty()) {
+            // tasks are cheaper in batches, but only while there is enough for every worker
+            int batch = std::min(config.taskBatch, std::max(1, (int) dataQueue.size() / workers));
+            int size = 1;
+            sendBuffer[0] = batch;
+            workerBound[workerId] = INT32_MIN;
+            workerTasks[workerId].clear();
+            for (int i = 0; i < batch; i++) {
+                workerTasks[workerId].push_back(dataQueue.packed(0));
+                workerBound[workerId] = std::max(workerBound[workerId], dataQueue.bound(0, *info));
+                size += dataQueue.pack(0, sendBuffer.data() + size, std::max(best->price, remoteBound));
+                dataQueue.pop_front();
+            }
+            MPI_Send(sendBuffer.data(), size, MPI_INT, workerId, TAG_WORK, MPI_COMM_WORLD);
+            workerState[workerId] = WORKER_BUSY;
+            return;
+        }
+
+        for (int i = 1; i <= workers; i++) {
+            int victim = (lastVictim + i - 1) % workers + 1;
+            if (victim == workerId || workerState[victim] != WORKER_BUSY || stealPending[victim])
+                continue;
+
+            int request[2] = {workerId, ++stealIds[workerId]};
+            MPI_Send(request, 2, MPI_INT, victim, TAG_STEAL, MPI_COMM_WORLD);
+            stealPending[victim] = true;
+            workerState[workerId] = WORKER_WAITING;
+            lastVictim = victim;
+            return;
+        }
+        workerState[workerId] = WORKER_IDLE;
+    }
+
+    bool workersActive() const {
+        for (size_t workerId = 1; workerId < workerState.size(); workerId++) {
+            if (workerState[workerId] != WORKER_IDLE || stealPending[workerId])
+                return true;
+        }
+        return false;
+    }
+
+    void sendBound(const int &destination, const int &price) {
+        boundValues.push_back(price);
+        boundRequests.emplace_back();
+        MPI_Isend(&boundValues.back(), 1, MPI_INT, destination, TAG_BOUND, MPI_COMM_WORLD, &boundRequests.back());
+    }
+
+    void finishBounds() {
+        MPI_Waitall((int) boundRequests.size(), boundRequests.data(), MPI_STATUSES_IGNORE);
+        boundRequests.clear();
+        boundValues.clear();
+    }
+
+    // best solution when it is better than the one sent last, false when it is not. Other threads of
+    // the search may be storing a better one meanwhile, price and map are read together
+    bool sendResult() {
+        int size = 0;
+        #pragma omp critical(best_map)
+        {
+            if (best->price > sentPrice) {
+                sendBuffer[0] = RESULT_VERSION;
+                sendBuffer[1] = best->price;
+                size = 2 + best->map.pack(sendBuffer.data() + 2);
+            }
+        }
+        if (size == 0)
+            return false;
+        MPI_Send(sendBuffer.data(), size, MPI_INT, 0, TAG_RESULT, MPI_COMM_WORLD);
+        sentPrice = sendBuffer[1];
+        return true;
+    }
+
+    // thief, request id, success and the task given away, master keeps it for checkpoints
+    void replySteal(const int *request, const QueueItem *task) {
+        sendBuffer[0] = request[0];
+        sendBuffer[1] = request[1];
+        sendBuffer[2] = task != nullptr;
+        int size = 3;
+        if (task)
+            size += task->pack(sendBuffer.data() + 3, bestPrice.load());
+        MPI_Send(sendBuffer.data(), size, MPI_INT, 0, TAG_STEAL_REPLY, MPI_COMM_WORLD);
+    }
+
+    void slave(const int & id) {
+        cout << "SLAVE:= " << id << " started" << endl;
+        vector<int> &buffer = receiveBuffer;
+        QueueItem task;
+        // one result object for all tasks of this rank
+        best = new SolverResult(emptyMap);
+        while (true) {
+            // work comes from master or from a peer sharing its search
+            MPI_Status status = receive();
+
+            cout << "SLAVE:= " << id << " - recieved: tag" << status.MPI_TAG << endl;
+
+            // signal to quit. Can go home.
+            if (status.MPI_TAG == TAG_END) break;
+
+            // asked to share work after finishing it, nothing to give
+            if (status.MPI_TAG == TAG_STEAL) {
+                replySteal(buffer.data(), nullptr);
+                continue;
+            }
+
+            if (status.MPI_TAG == TAG_BOUND) {
+                remoteBound = std::max(remoteBound, buffer[0]);
+                STATS(counters().boundsReceived++);
+                continue;
+            }
+
+            // stopped by the clock already or between tasks, work still on the way is skipped
+            if (status.MPI_TAG == TAG_STOP) {
+                stopping = true;
+                continue;
+            }
+
+            // batch of tasks, better solutions go out as they come, one TAG_DONE for all
+            int tasks = buffer[0];
+            int offset = 1;
+            int end;
+            MPI_Get_count(&status, MPI_INT, &end);
+            best->price = INT32_MIN;
+            currentTask = &task;
+            for (int i = 0; i < tasks; i++) {
+                int taskBestprice;
+                offset += task.unpack(buffer.data() + offset, emptyMap, taskBestprice);
+                pendingOffset = offset;
+                pendingSize = end - offset;
+                pendingCount = tasks - i - 1;
+                if (i == 0)
+                    sentPrice = taskBestprice;
+                taskWeight = task.weight;
+                donatedWeight = 0;
+                taskBound = task.price + info->getUpperPrice(task.uncovered);
+                if (stopping || timeUp()) {
+                    stopping = true;
+                    stopBound = std::max(stopBound, taskBound);
+                    continue;
+                }
+
+                startSolve(&task.map, task.price, task.uncovered, task.branches,
+                           std::max(taskBestprice, remoteBound));
+                // result goes after the bounds, master reads them in order
+                finishBounds();
+                // serial search put its open nodes into stopBound when it stopped
+                if (stopping) {
+                    if (!tracking())
+                        stopBound = std::max(stopBound, taskBound);
+                    continue;
+                }
+                // what was given away is reported by the ranks that took it
+                doneWeight += taskWeight - donatedWeight;
+            }
+            currentTask = nullptr;
+            pendingSize = pendingCount = 0;
+
+            // whatever was not sent while searching, before the progress that clears the work
+            if (sendResult())
+                cout << "SLAVE:= " << id << " - sent RESULT" << endl;
+            if (config.progressInterval > 0)
+                sendProgress(doneWeight, INT32_MIN, config.checkpointFile.empty() ? -1 : 0);
+            cout << "SLAVE:= " << id << " - sending DONE" << endl;
+            MPI_Send(&stopBound, 1, MPI_INT, 0, TAG_DONE, MPI_COMM_WORLD);
+            stopBound = INT32_MIN;
+        }
+        cout << "SLAVE:= " << id << " ends" << endl;
+
+    }
+
+    void solve_bfs(ArrayMap *map, int price, int uncovered, long long weight) {
+        solve_bfs(map, price, uncovered, weight, dataQueue);
+    }
+
+    template<class Queue>
+    void solve_bfs(ArrayMap *map, int price, int uncovered, long long weight, Queue &queue) {
+        bool horizontalI2 = map->canPlaceHorizontal(info->i2);
+        bool verticalI2 = map->canPlaceVertical(info->i2);
+        bool horizontalI1 = map->canPlaceHorizontal(info->i1);
+        bool verticalI1 = map->canPlaceVertical(info->i1);
+        weight /= 1 + horizontalI2 + verticalI2 + horizontalI1 + verticalI1;
+
+        //place H I2
+        if (horizontalI2) {
+            queue.push_back(QueueItem(map->placeHorizontal(info->i2), price + info->c2, uncovered - info->i2, weight));
+        }
+
+        //place V I2
+        if (verticalI2) {
+            queue.push_back(QueueItem(map->placeVertical(info->i2), price + info->c2, uncovered - info->i2, weight));
+        }
+
+        //place H I1
+        if (horizontalI1) {
+            queue.push_back(QueueItem(map->placeHorizontal(info->i1), price + info->c1, uncovered - info->i1, weight));
+        }
+
+        //place V I1
+        if (verticalI1) {
+            queue.push_back(QueueItem(map->placeVertical(info->i1), price + info->c1, uncovered - info->i1, weight));
+        }
+
+        //SKIP on purpose
+        map->nextFree();
+        queue.push_back(QueueItem(*map, price + info->cn, uncovered - 1, weight));
+    }
+
+    void solve_dfs(ArrayMap *map, int price, int uncovered) {
+        int upperPrice = info->getUpperPrice(uncovered);
+        STATS(counters().nodes++);
+        STATS(counters().depth[depthBucket[uncovered]]++);
+
+        if (price + upperPrice <= best->price) {
+            STATS(counters().prunes++);
+            return;
+        }
+        if (best->price == info->optimPrice) {
+            STATS(counters().optimumCutoffs++);
+            return;
+        }
+        if (mirrored(*map))
+            return;
+
+        if (price + info->cn * uncovered > best->price) {
+            best->map = *map;
+            best->price = price + info->cn * uncovered;
+            STATS(counters().improvements++);
+        }
+
+        if (finished<GenericKernel>(*map, uncovered))
+            return;
+
+        if (map->freeBlock()) {
+            //place H I2
+            if (map->canPlaceHorizontal(info->i2)) {
+                ArrayMap modifiedMap = map->placeHorizontal(info->i2);
+                solve_dfs(&modifiedMap, price + info->c2, uncovered - info->i2);
+            }
+
+            //place V I2
+            if (map->canPlaceVertical(info->i2)) {
+                ArrayMap modifiedMap = map->placeVertical(info->i2);
+                solve_dfs(&modifiedMap, price + info->c2, uncovered - info->i2);
+            }
+
+            //place H I1
+            if (map->canPlaceHorizontal(info->i1)) {
+                ArrayMap modifiedMap = map->placeHorizontal(info->i1);
+                solve_dfs(&modifiedMap, price + info->c1, uncovered - info->i1);
+            }
+
+            //place V I1
+            if (map->canPlaceVertical(info->i1)) {
+                ArrayMap modifiedMap = map->placeVertical(info->i1);
+                solve_dfs(&modifiedMap, price + info->c1, uncovered - info->i1);
+            }
+            //SKIP on purpose
+            map->nextFree();
+            solve_dfs(map, price + info->cn, uncovered - 1);
+        } else { // standing on forbiden or placed tile
+            map->nextFree();
+            solve_dfs(map, price, uncovered);
+        }
+    }
+
+    void storeBest(const ArrayMap &map, const vector<Move> &) {
+        best->map = map;
+    }
+
+    void storeBest(const BitMap &map, const vector<Move> &undo) {
+        best->map = map.replay(*taskMap, undo);
+    }
+
+    template<class Board>
+    void offerBest(const Board &map, const vector<Move> &undo, const int &price) {
+        int current = bestPrice.load();
+        while (price > current) {
+            if (bestPrice.compare_exchange_weak(current, price)) {
+                // price already published, the map may lag behind a moment
+                #pragma omp critical(best_map)
+                {
+                    if (price > best->price) {
+                        storeBest(map, undo);
+                        best->price = price;
+                    }
+                }
+                STATS(counters().improvements++);
+                // serial worker tells others at once, threads' results go with the task result.
+                // Master relays its own when it serves workers next
+                if (tracking()) {
+                    localBound = price;
+                    if (rank > 0)
+                        sendBound(0, price);
+                }
+                return;
+            }
+        }
+    }
+
+    template<class Kernel>
+    int upperPriceOf(const ArrayMap &, const int &uncovered) const {
+        return info->getUpperPrice(uncovered);
+    }
+
+    template<class Kernel>
+    int upperPriceOf(const BitMap &map, const int &uncovered) const {
+        if (!config.tightBound)
+            return info->getUpperPrice(uncovered);
+        int dead = map.deadCells<Kernel::SHORTEST>(Kernel::shortest(*info));
+        return info->getUpperPrice(uncovered - dead) + dead * info->cn;
+    }
+
+    bool transposed(const ArrayMap &, const int &, const int &) {
+        return false;
+    }
+
+    bool transposed(const BitMap &map, const int &price, const int &uncovered) {
+        // a frontier seen before may have had its leaders cut, under another prefix they can be needed
+        if (!table || uncovered < config.ttCells || map.y < config.symmetryRows)
+            return false;
+
+        bool hit = table->dominated(table->key(map), price);
+        STATS(counters().ttProbes++);
+        STATS(counters().ttHits += hit);
+        return hit;
+    }
+
+    // node entry: counts the node, runs the hook and walks the cursor over covered cells.
+    // True when it stops on a free cell whose branches are to be searched
+    template<class Kernel, class Board>
+    bool enter(Board *map, vector<Move> *undo, const int &price, const int &uncovered) {
+        STATS(SearchStats &nodeStats = counters());
+        while (true) {
+            STATS(nodeStats.nodes++);
+            STATS(nodeStats.depth[depthBucket[uncovered]]++);
+            if (tracking()) {
+                if (++nodesSincePoll >= config.pollInterval) {
+                    nodesSincePoll = 0;
+                    if (rank == 0)
+                        serve(*map, *undo);
+                    else
+                        poll(*map, *undo);
+                }
+            } else if ((config.timeLimit > 0 || masterSearching || rank > 0)
+                       && ++thread().nodesSinceCheck >= config.pollInterval) {
+                // MPI is funneled through the main thread -- it serves the workers on the master and
+                // polls the master on a worker, both watch the clock. Other threads of a worker watch
+                // it too, those of the master leave stopping to serve()
+                thread().nodesSinceCheck = 0;
+                if (masterSearching && omp_get_thread_num() == 0)
+                    serve(*map, *undo);
+                else if (rank > 0 && omp_get_thread_num() == 0)
+                    poll(*map, *undo);
+                else if (!masterSearching && timeUp())
+                    stopping = true;
+            }
+            if (stopping.load(memory_order_relaxed))
+                return false;
+
+            int upperPrice = upperPriceOf<Kernel>(*map, uncovered);
+            int bound = bestPrice.load(memory_order_relaxed);
+
+            if (price + upperPrice <= bound) {
+                STATS(nodeStats.prunes++);
+                // only the serial worker keeps its own bound apart
+                STATS(nodeStats.remotePrunes += tracking() && price + upperPrice > localBound);
+                return false;
+            }
+            if (bound == info->optimPrice) {
+                STATS(nodeStats.optimumCutoffs++);
+                return false;
+            }
+            if (mirrored(*map))
+                return false;
+
+            if (price + info->cn * uncovered > bound)
+                offerBest(*map, *undo, price + info->cn * uncovered);
+
+            if (finished<Kernel>(*map, uncovered))
+                return false;
+            if (map->freeBlock())
+                return !transposed(*map, price, uncovered);
+            // standing on forbiden or placed tile, the cell after it is a node of its own
+            map->nextFree();
+        }
+    }
+
+    // open node on top of the stack, the board is as it was entered
+    template<class Kernel, class Board>
+    void push(const Board &map, const vector<Move> &undo, vector<Frame> &stack, int price, int uncovered,
+              int branches) {
+        // board is back as it was before every branch, so what fits is known up front
+        int valid = branches & feasible<Kernel>(map);
+        long long weight = stack.empty() ? taskWeight : stack.back().weight / __builtin_popcount(stack.back().valid);
+        stack.push_back({map.x, map.y, price, uncovered, undo.size(), order[0], 0, branches, valid, weight, 0});
+    }
+
+    // Depth first search without recursion. Every open node is a Frame of the stack, the bottom one
+    // is the node the search started in and the top one the node being searched. A frame is on its
+    // branch while next is past it and the branch is not done yet, coming back to it takes the tile
+    // off. Root search starts on any cell, otherwise on a free one with the given branches
+    template<class Kernel, class Board>
+    void solve_dfs_inplace(Board *map, vector<Move> *undo, vector<Frame> &stack, int price, int uncovered,
+                           int depth, int branches, bool root) {
+        int x = map->x;
+        int y = map->y;
+        size_t bottom = stack.size();
+        if (!root || enter<Kernel>(map, undo, price, uncovered))
+            push<Kernel>(*map, *undo, stack, price, uncovered, branches);
+
+        const int i1 = Kernel::first(*info), i2 = Kernel::second(*info);
+        while (stack.size() > bottom) {
+            Frame &frame = stack.back();
+            if (frame.next > 0 && !(frame.done & (1 << frame.branch))) {
+                if (frame.branch != BRANCH_SKIP) {
+                    map->undo(undo->back());
+                    undo->pop_back();
+                }
+                frame.done |= 1 << frame.branch;
+            }
+            if (stopping.load(memory_order_relaxed)) {
+                stack.pop_back();
+                continue;
+            }
+
+            // some branches may have been given away meanwhile
+            int valid = frame.valid & frame.branches;
+            while (frame.next < BRANCH_COUNT && !(valid & (1 << order[frame.next])))
+                frame.next++;
+            if (frame.next == BRANCH_COUNT) {
+                stack.pop_back();
+                continue;
+            }
+            int branch = order[frame.next++];
+            frame.branch = branch;
+
+            int tile = 0, childPrice = frame.price + info->cn;
+            if (branch == BRANCH_H_I2 || branch == BRANCH_V_I2) {
+                tile = i2;
+                childPrice = frame.price + info->c2;
+            } else if (branch == BRANCH_H_I1 || branch == BRANCH_V_I1) {
+                tile = i1;
+                childPrice = frame.price + info->c1;
+            }
+            bool vertical = branch == BRANCH_V_I2 || branch == BRANCH_V_I1;
+            int childUncovered = frame.uncovered - (tile > 0 ? tile : 1);
+            int frameDepth = depth + (int) (stack.size() - bottom) - 1;
+            map->x = frame.x;
+            map->y = frame.y;
+
+            if (spawnTask(childUncovered, frameDepth)) {
+                spawn<Kernel>(*map, *undo, tile, vertical, childPrice, childUncovered, frameDepth + 1);
+                frame.done |= 1 << branch;
+                continue;
+            }
+            // skip moves only the cursor
+            if (tile > 0)
+                undo->push_back(vertical ? map->placeVerticalInPlace(tile) : map->placeHorizontalInPlace(tile));
+            else
+                map->nextFree();
+            if (enter<Kernel>(map, undo, childPrice, childUncovered))
+                push<Kernel>(*map, *undo, stack, childPrice, childUncovered, ALL_BRANCHES);
+        }
+        map->x = x;
+        map->y = y;
+    }
+
+    // some mirror or rotation of every solution below reads higher than it
+    template<class Board>
+    bool mirrored(const Board &map) {
+        if (map.y >= config.symmetryRows || symmetry.leader(map))
+            return false;
+        STATS(counters().symmetryCuts++);
+        return true;
+    }
+
+    template<class Kernel, class Board>
+    int feasible(const Board &map) const {
+        const int i1 = Kernel::first(*info), i2 = Kernel::second(*info);
+        return (map.canPlaceHorizontal(i2) << BRANCH_H_I2) | (map.canPlaceVertical(i2) << BRANCH_V_I2)
+               | (map.canPlaceHorizontal(i1) << BRANCH_H_I1) | (map.canPlaceVertical(i1) << BRANCH_V_I1)
+               | (1 << BRANCH_SKIP);
+    }
+
+    // nothing is left to decide. The cursor stays on the last cell, a free one is still searched
+    // while it is not decided and a tile of length 1 could take it
+    template<class Kernel, class Board>
+    bool finished(const Board &map, const int &uncovered) const {
+        return map.isOnRightBottomCorner() && (Kernel::shortest(*info) > 1 || uncovered == 0 || !map.freeBlock());
+    }
+
+    // serial search on a worker or the master keeps its open nodes so they can be donated.
+    // Threads keep none, poll() and serve() see the whole task as open and donate nothing
+    bool tracking() const {
+        return config.threads == 1 && (rank > 0 || masterSearching);
+    }
+
+    template<class Board>
+    void poll(const Board &map, const vector<Move> &undo) {
+        int flag;
+        MPI_Status status;
+        MPI_Iprobe(0, TAG_BOUND, MPI_COMM_WORLD, &flag, &status);
+        while (flag) {
+            int price;
+            MPI_Recv(&price, 1, MPI_INT, 0, TAG_BOUND, MPI_COMM_WORLD, &status);
+            STATS(counters().boundsReceived++);
+            remoteBound = std::max(remoteBound, price);
+            // raise the bound only, best->map stays with our own solution
+            int current = bestPrice.load();
+            while (price > current && !bestPrice.compare_exchange_weak(current, price));
+            MPI_Iprobe(0, TAG_BOUND, MPI_COMM_WORLD, &flag, &status);
+        }
+
+        // master gets the solution while the task still runs, the bound went already.
+        // It goes before the progress, a checkpoint must not lose it with the finished work
+        sendResult();
+
+        if (config.progressInterval > 0 && MPI_Wtime() - lastProgress >= config.progressInterval) {
+            int count = config.checkpointFile.empty() ? -1 : packOpenWork(map, undo);
+            sendProgress(doneWeight + openWeight(), openBound(), count);
+        }
+
+        MPI_Iprobe(0, TAG_STOP, MPI_COMM_WORLD, &flag, &status);
+        if (flag) {
+            int dummy;
+            MPI_Recv(&dummy, 1, MPI_INT, 0, TAG_STOP, MPI_COMM_WORLD, &status);
+        }
+        if (flag || timeUp()) {
+            // open nodes are gone once the search unwinds, steal requests get a refusal after it
+            stopping = true;
+            stopBound = std::max(stopBound, openBound());
+            return;
+        }
+
+        MPI_Iprobe(0, TAG_STEAL, MPI_COMM_WORLD, &flag, &status);
+        if (!flag)
+            return;
+
+        int request[2];
+        MPI_Recv(request, 2, MPI_INT, 0, TAG_STEAL, MPI_COMM_WORLD, &status);
+
+        QueueItem task;
+        bool success = donate(map, undo, task);
+        if (success) {
+            sendBuffer[0] = 1;
+            int size = 1 + task.pack(sendBuffer.data() + 1, bestPrice.load());
+            MPI_Send(sendBuffer.data(), size, MPI_INT, request[0], TAG_WORK, MPI_COMM_WORLD);
+        }
+        replySteal(request, success ? &task : nullptr);
+    }
+
+    // hand over all unexplored branches of the shallowest open node
+    template<class Board>
+    bool donate(const Board &map, const vector<Move> &undo, QueueItem &task) {
+        for (Frame &frame : frames) {
+            int rest = frame.branches & frame.valid & ~frame.done & ~(1 << frame.branch);
+            if (rest == 0 || frame.uncovered < config.stealCells)
+                continue;
+
+            long long weight = frame.weight / __builtin_popcount(frame.valid) * __builtin_popcount(rest);
+            task = QueueItem(snapshot(map, undo, frame), frame.price, frame.uncovered, weight, rest);
+            frame.branches &= ~rest;
+            donatedWeight += weight;
+            return true;
+        }
+        return false;
+    }
+
+    // board as it was when the frame was entered
+    ArrayMap snapshot(const ArrayMap &map, const vector<Move> &undo, const Frame &frame) const {
+        ArrayMap result = map;
+        for (size_t i = undo.size(); i > frame.undoSize; i--)
+            result.undo(undo[i - 1]);
+        result.x = frame.x;
+        result.y = frame.y;
+        return result;
+    }
+
+    ArrayMap snapshot(const BitMap &, const vector<Move> &undo, const Frame &frame) const {
+        ArrayMap result = *taskMap;
+        result.replay(undo, frame.undoSize);
+        result.x = frame.x;
+        result.y = frame.y;
+        return result;
+    }
+
+    bool spawnTask(const int &uncovered, const int &depth) const {
+        return config.threads > 1 && depth < config.taskDepth && uncovered > config.taskCells;
+    }
+
+    // task gets its own copy of board, undo stack and frame stack, kept out of line from the serial path
+    template<class Kernel, class Board>
+    void spawn(const Board &map, const vector<Move> &undo, const int &tile, bool vertical, int price, int uncovered,
+               int depth) {
+        Board child = map;
+        vector<Move> childUndo = undo;
+        if (tile > 0)
+            childUndo.push_back(vertical ? child.placeVerticalInPlace(tile) : child.placeHorizontalInPlace(tile));
+        else
+            child.nextFree();
+        #pragma omp task firstprivate(child, childUndo, price, uncovered, depth)
+        {
+            vector<Frame> stack;
+            stack.reserve((size_t) uncovered + 1);
+            solve_dfs_inplace<Kernel>(&child, &childUndo, stack, price, uncovered, depth, ALL_BRANCHES, true);
+        }
+    }
+
+    // in place search prunes by bound from the start, best keeps only solutions better than it
+    void startSolve(ArrayMap *map, int price, int uncovered, int branches = ALL_BRANCHES, int bound = INT32_MIN) {
+        if (config.mode == SearchMode::COPY) {
+            startSolveCopy(map, price, uncovered);
+        } else if (config.mode == SearchMode::BITBOARD) {
+            // task map stays untouched, replay() rebuilds tile ids on top of it
+            BitMap bits(*map);
+            taskMap = map;
+            startSolveInPlace(&bits, price, uncovered, branches, bound);
+            taskMap = nullptr;
+        } else {
+            startSolveInPlace(map, price, uncovered, branches, bound);
+        }
+    }
+
+    // tile pairs of the instances we run get a search of their own, see TileKernel
+    template<class Board>
+    void startSolveInPlace(Board *map, int price, int uncovered, int branches, int bound) {
+        if (config.tileKernels && TileKernel<2, 3>::matches(*info))
+            startKernel<TileKernel<2, 3>>(map, price, uncovered, branches, bound);
+        else if (config.tileKernels && TileKernel<2, 4>::matches(*info))
+            startKernel<TileKernel<2, 4>>(map, price, uncovered, branches, bound);
+        else if (config.tileKernels && TileKernel<3, 5>::matches(*info))
+            startKernel<TileKernel<3, 5>>(map, price, uncovered, branches, bound);
+        else if (config.tileKernels && TileKernel<4, 7>::matches(*info))
+            startKernel<TileKernel<4, 7>>(map, price, uncovered, branches, bound);
+        else
+            startKernel<GenericKernel>(map, price, uncovered, branches, bound);
+    }
+
+    template<class Kernel, class Board>
+    void startKernel(Board *map, int price, int uncovered, int branches, int bound) {
+        // one undo record per placed tile is the deepest the stack can get
+        vector<Move> undo;
+        undo.reserve(uncovered / min(info->i1, info->i2) + 1);
+        bestPrice = std::max(best->price, bound);
+        localBound = bestPrice;
+        frames.clear();
+        frames.reserve((size_t) uncovered + 1);
+        nodesSincePoll = 0;
+
+        // task may stop on the last cell or on a covered one, its branches are those of a free cell
+        bool root = branches == ALL_BRANCHES && (!map->freeBlock() || map->isOnRightBottomCorner());
+        if (config.threads > 1) {
+            // tasks keep stacks of their own, nothing tracks them
+            #pragma omp parallel num_threads(config.threads)
+            #pragma omp single
+            {
+                vector<Frame> stack;
+                stack.reserve((size_t) uncovered + 1);
+                solve_dfs_inplace<Kernel>(map, &undo, stack, price, uncovered, 0, branches, root);
+            }
+        } else {
+            solve_dfs_inplace<Kernel>(map, &undo, frames, price, uncovered, 0, branches, root);
+        }
+    }
+
+    void startSolveCopy(ArrayMap *map, int price, int uncovered) {
+        if (!map->freeBlock() || map->isOnRightBottomCorner()) {
+            solve_dfs(map, price, uncovered);
+            return;
+        }
+
+        //place H I2
+        if (map->canPlaceHorizontal(info->i2)) {
+            ArrayMap modifiedMap = map->placeHorizontal(info->i2);
+            solve_dfs(&modifiedMap, price + info->c2, uncovered - info->i2);
+        }
+
+        //place V I2
+        if (map->canPlaceVertical(info->i2)) {
+            ArrayMap modifiedMap = map->placeVertical(info->i2);
+            solve_dfs(&modifiedMap, price + info->c2, uncovered - info->i2);
+        }
+
+        //place H I1
+        if (map->canPlaceHorizontal(info->i1)) {
+            ArrayMap modifiedMap = map->placeHorizontal(info->i1);
+            solve_dfs(&modifiedMap, price + info->c1, uncovered - info->i1);
+        }
+
+        //place V I1
+        if (map->canPlaceVertical(info->i1)) {
+            ArrayMap modifiedMap = map->placeVertical(info->i1);
+            solve_dfs(&modifiedMap, price + info->c1, uncovered - info->i1);
+        }
+
+        //SKIP on purpose
+        map->nextFree();
+        solve_dfs(map, price + info->cn, uncovered - 1);
+    }
+
+
+    void FindLeftEmptyTiles() const {
+        best->findLeftEmptyTiles();
+    }
+
+    void prepare_tasks(ArrayMap &map, unsigned int max) {
+        dataQueue.push_back(QueueItem(map, 0, info->startUncovered, TREE_WEIGHT));
+        // tasks on the last cell have nothing to split, small boards may hold nothing else
+        size_t leaves = 0;
+        while (dataQueue.size() < max && leaves < dataQueue.size()) {
+            QueueItem item = dataQueue.front(emptyMap);
+            dataQueue.pop_front();
+            if (item.map.isOnRightBottomCorner()) {
+                dataQueue.push_back(item);
+                leaves++;
+                continue;
+            }
+            leaves = 0;
+            solve_bfs(&item.map, item.price, item.uncovered, item.weight);
+        }
+    }
+
+    struct EstimatedTask {
+        double size;
+        size_t task; // in the arena of prepare_estimated_tasks()
+
+        bool operator<(const EstimatedTask &other) const {
+            return size < other.size;
+        }
+    };
+
+    // split the task with the largest estimated subtree until there are enough of similar size,
+    // queue goes largest first
+    void prepare_estimated_tasks(const ArrayMap &map, const unsigned int &max) {
+        SubtreeEstimator estimator(info, config.probes);
+        estimator.incumbent = best->price;
+        estimator.warmUp(map, 0, info->startUncovered);
+
+        TaskQueue arena;              // every task made, split ones included
+        vector<EstimatedTask> tasks;  // max heap by size
+        vector<EstimatedTask> leaves; // nothing to split any more
+        arena.push_back(QueueItem(map, 0, info->startUncovered, TREE_WEIGHT));
+        tasks.push_back({estimator.estimate(map, 0, info->startUncovered), 0});
+        double total = tasks.front().size;
+        // keeps the master from splitting forever when sizes stay uneven
+        const size_t limit = 8 * (size_t) max;
+
+        while (!tasks.empty() && tasks.size() + leaves.size() < limit) {
+            size_t count = tasks.size() + leaves.size();
+            const EstimatedTask &largest = tasks.front();
+            if (count >= max && largest.size <= config.taskBalance * total / (double) count)
+                break;
+
+            pop_heap(tasks.begin(), tasks.end());
+            EstimatedTask task = tasks.back();
+            tasks.pop_back();
+            QueueItem item = arena.get(task.task, emptyMap);
+            if (estimator.leaf(item.map, item.price, item.uncovered)) {
+                leaves.push_back(task);
+                continue;
+            }
+
+            total -= task.size;
+            vector<QueueItem> children;
+            solve_bfs(&item.map, item.price, item.uncovered, item.weight, children);
+            for (QueueItem &child : children) {
+                double size = estimator.estimate(child.map, child.price, child.uncovered);
+                total += size;
+                tasks.push_back({size, arena.size()});
+                push_heap(tasks.begin(), tasks.end());
+                arena.push_back(child);
+            }
+        }
+
+        tasks.insert(tasks.end(), leaves.begin(), leaves.end());
+        sort(tasks.rbegin(), tasks.rend());
+        for (const EstimatedTask &task : tasks)
+            dataQueue.push_back(arena.packed(task.task));
+        cout << "MASTER - " << tasks.size() << " tasks, estimated nodes " << tasks.front().size << " largest, "
+             << tasks.back().size << " smallest, " << total << " total" << endl;
+    }
+
+    void printMap(const ArrayMap &matrix, const int &cx, const int &cy, const int &price, const int &uncovered) const {
+        cout << "X: " << cx << " Y: " << cy << " P: " << price << " B: " << best->price <<
+             " U: " << uncovered << endl;
+        cout << matrix << endl;
+    }
+
+};
+
+// -----------------------------------------------------------------------------------------------------------------
+
+// command line option of the solver, false if arg is none of them. A value that is no number throws
+// invalid_argument or out_of_range from stoi and stod, callers report it as a usage error
+inline bool parseOption(const string &arg, SolverConfig &config) {
+    if (arg == "--engine=auto")
+        config.engine = Engine::AUTO;
+    else if (arg == "--engine=bnb")
+        config.engine = Engine::BRANCH_AND_BOUND;
+    else if (arg == "--engine=dp")
+        config.engine = Engine::PROFILE_DP;
+    else if (arg.compare(0, 10, "--dp-bits=") == 0)
+        config.dpBits = stoi(arg.substr(10));
+    else if (arg.compare(0, 12, "--dp-states=") == 0)
+        config.dpStates = stoll(arg.substr(12));
+    else if (arg == "--search=copy")
+        config.mode = SearchMode::COPY;
+    else if (arg == "--search=inplace")
+        config.mode = SearchMode::IN_PLACE;
+    else if (arg == "--search=bitboard")
+        config.mode = SearchMode::BITBOARD;
+    else if (arg.compare(0, 10, "--threads=") == 0)
+        config.threads = stoi(arg.substr(10));
+    else if (arg.compare(0, 13, "--task-depth=") == 0)
+        config.taskDepth = stoi(arg.substr(13));
+    else if (arg.compare(0, 13, "--task-cells=") == 0)
+        config.taskCells = stoi(arg.substr(13));
+    else if (arg.compare(0, 16, "--poll-interval=") == 0)
+        config.pollInterval = stoi(arg.substr(16));
+    else if (arg.compare(0, 14, "--steal-cells=") == 0)
+        config.stealCells = stoi(arg.substr(14));
+    else if (arg.compare(0, 10, "--tt-bits=") == 0)
+        config.ttBits = stoi(arg.substr(10));
+    else if (arg.compare(0, 11, "--tt-cells=") == 0)
+        config.ttCells = stoi(arg.substr(11));
+    else if (arg == "--bound=simple")
+        config.tightBound = false;
+    else if (arg == "--bound=tight")
+        config.tightBound = true;
+    else if (arg.compare(0, 11, "--progress=") == 0)
+        config.progressInterval = stod(arg.substr(11));
+    else if (arg.compare(0, 13, "--task-batch=") == 0)
+        config.taskBatch = max(1, stoi(arg.substr(13)));
+    else if (arg.compare(0, 19, "--tasks-per-worker=") == 0)
+        config.tasksPerWorker = stoi(arg.substr(19));
+    else if (arg.compare(0, 15, "--task-balance=") == 0)
+        config.taskBalance = stod(arg.substr(15));
+    else if (arg.compare(0, 9, "--probes=") == 0)
+        config.probes = stoi(arg.substr(9));
+    else if (arg.compare(0, 7, "--beam=") == 0)
+        config.beamWidth = stoi(arg.substr(7));
+    else if (arg == "--order=fixed")
+        config.order = BranchOrder::FIXED;
+    else if (arg == "--order=ratio")
+        config.order = BranchOrder::RATIO;
+    else if (arg.compare(0, 16, "--symmetry-rows=") == 0)
+        config.symmetryRows = stoi(arg.substr(16));
+    else if (arg.compare(0, 13, "--time-limit=") == 0)
+        config.timeLimit = stod(arg.substr(13));
+    else if (arg.compare(0, 6, "--gap=") == 0)
+        config.gap = stod(arg.substr(6));
+    else if (arg.compare(0, 13, "--checkpoint=") == 0)
+        config.checkpointFile = arg.substr(13);
+    else if (arg.compare(0, 22, "--checkpoint-interval=") == 0)
+        config.checkpointInterval = stod(arg.substr(22));
+    else if (arg.compare(0, 9, "--resume=") == 0)
+        config.resumeFile = arg.substr(9);
+    else if (arg == "--kernels=fixed")
+        config.tileKernels = true;
+    else if (arg == "--kernels=generic")
+        config.tileKernels = false;
+    else if (arg == "--master-search=on")
+        config.masterSearch = true;
+    else if (arg == "--master-search=off")
+        config.masterSearch = false;
+    else if (arg == "--regions=on")
+        config.regions = true;
+    else if (arg == "--regions=off")
+        config.regions = false;
+    else
+        return false;
+    return true;
+}
+
+// ProfileSolver is asked for or chosen by AUTO, and the profile fits its state
+inline bool useProfileDp(const MapInfo &info, const SolverConfig &config) {
+    int bits = ProfileSolver::profileBits(info);
+    if (bits > ProfileSolver::MAX_PROFILE)
+        return false;
+    return config.engine == Engine::PROFILE_DP || (config.engine == Engine::AUTO && bits <= config.dpBits);
+}
+
+// ProfileSolver on rank 0, false on every rank when its states did not fit into config.dpStates and
+// branch and bound has to solve the board instead. All ranks must call it, result and states are
+// valid on rank 0 only
+inline bool solveProfileDp(const MapInfo *info, const SolverConfig &config, SolverResult &result, size_t &states) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    int complete = 1;
+    if (rank == 0) {
+        ProfileSolver solver(info, (size_t) std::max(config.dpStates, 0LL));
+        result = solver.solve();
+        states = solver.states;
+        complete = result.price != INT32_MIN;
+    }
+    MPI_Bcast(&complete, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    return complete != 0;
+}
+
+#endif //MI_PDP_SOLVER_H
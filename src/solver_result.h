@@ -0,0 +1,67 @@
+#include <cstdint>
+#include <iostream>
+#include <set>
+
+#include "array_map.h"
+
+#ifndef MI_PDP_SOLVER_RESULT_H
+#define MI_PDP_SOLVER_RESULT_H
+
+using namespace std;
+
+class SolverResult {
+public:
+    set<pair<int, int>> empty;
+    int price;
+    ArrayMap map;
+
+    SolverResult(ArrayMap map)
+            : price(INT32_MIN), map(std::move(map)) {
+    }
+
+    void findLeftEmptyTiles() {
+        for (int x = 0; x < map.columns; x++) {
+            for (int y = 0; y < map.rows; y++) {
+                if (map.getValue(x, y) == BLOCK_FREE) {
+                    empty.insert(make_pair(x, y));
+                }
+            }
+        }
+    }
+
+    friend ostream &operator<<(ostream &out, const SolverResult &result);
+};
+
+inline ostream &operator<<(ostream &os, const ArrayMap &map) {
+    for (int y = 0; y < map.rows; y++) {
+        for (int x = 0; x < map.columns; x++) {
+            int p = map.getValue(x, y);
+            switch (p) {
+                case BLOCK_FREE :
+                    os << ".\t";
+                    break;
+                case BLOCK_BAN :
+                    os << "X\t";
+                    break;
+                default:
+                    os << p << "\t";
+                    break;
+            }
+        }
+        os << endl;
+    }
+
+    return os;
+}
+
+inline ostream &operator<<(ostream &os, const SolverResult &result) {
+    os << result.map;
+    os << result.price << endl;
+    os << result.empty.size() << endl;
+    for (const auto &p : result.empty)
+        os << p.first << " " << p.second << endl;
+
+    return os;
+}
+
+#endif //MI_PDP_SOLVER_RESULT_H
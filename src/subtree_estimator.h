@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <random>
+
+#include "array_map.h"
+#include "map_info.h"
+
+#ifndef MI_PDP_SUBTREE_ESTIMATOR_H
+#define MI_PDP_SUBTREE_ESTIMATOR_H
+
+using namespace std;
+
+// Knuth's estimator of the search tree size -- random walks from a node down to a leaf, the walk
+// counts every level as if all its siblings looked the same. Averaged over probes it is an
+// unbiased guess of the node count, good enough to tell big tasks from small ones.
+//
+// Walks prune like the search does, against the best price seen by earlier walks. warmUp() sets
+// that price first, so all tasks are estimated against the same bound.
+class SubtreeEstimator {
+public:
+    int incumbent; // best price found by any walk
+
+    SubtreeEstimator(const MapInfo *info, const int &probes, const unsigned int &seed = 1)
+            : incumbent(INT32_MIN), info(info), probes(probes), random(seed) {
+    }
+
+    void warmUp(const ArrayMap &map, const int &price, const int &uncovered) {
+        for (int i = 0; i < probes; i++)
+            walk(map, price, uncovered, true);
+    }
+
+    double estimate(const ArrayMap &map, const int &price, const int &uncovered) {
+        double total = 0;
+        for (int i = 0; i < probes; i++)
+            total += walk(map, price, uncovered, false);
+        return total / probes;
+    }
+
+    // same stops as Solver::solve_dfs, nothing left to split below them
+    bool leaf(const ArrayMap &map, const int &price, const int &uncovered) const {
+        return map.isOnRightBottomCorner() || price + info->getUpperPrice(uncovered) <= incumbent;
+    }
+
+private:
+    const MapInfo *info;
+    int probes;
+    mt19937 random;
+
+    double walk(ArrayMap map, int price, int uncovered, const bool &raise) {
+        double level = 1; // nodes on the current level if the tree were uniform
+        double nodes = 1;
+        while (true) {
+            if (price + info->getUpperPrice(uncovered) <= incumbent)
+                return nodes;
+            if (raise)
+                incumbent = max(incumbent, price + info->cn * uncovered);
+            if (map.isOnRightBottomCorner())
+                return nodes;
+
+            if (!map.freeBlock()) {
+                map.nextFree();
+                continue;
+            }
+
+            bool fits[4] = {map.canPlaceHorizontal(info->i2), map.canPlaceVertical(info->i2),
+                            map.canPlaceHorizontal(info->i1), map.canPlaceVertical(info->i1)};
+            int children = 1 + fits[0] + fits[1] + fits[2] + fits[3];
+            int pick = uniform_int_distribution<int>(0, children - 1)(random);
+            level *= children;
+            nodes += level;
+
+            // pick-th child in branch order, skip is the last one
+            int branch = 0;
+            for (; branch < 4; branch++) {
+                if (fits[branch] && pick-- == 0)
+                    break;
+            }
+            switch (branch) {
+                case 0:
+                    map.placeHorizontalInPlace(info->i2);
+                    price += info->c2;
+                    uncovered -= info->i2;
+                    break;
+                case 1:
+                    map.placeVerticalInPlace(info->i2);
+                    price += info->c2;
+                    uncovered -= info->i2;
+                    break;
+                case 2:
+                    map.placeHorizontalInPlace(info->i1);
+                    price += info->c1;
+                    uncovered -= info->i1;
+                    break;
+                case 3:
+                    map.placeVerticalInPlace(info->i1);
+                    price += info->c1;
+                    uncovered -= info->i1;
+                    break;
+                default:
+                    map.nextFree();
+                    price += info->cn;
+                    uncovered--;
+                    break;
+            }
+        }
+    }
+};
+
+#endif //MI_PDP_SUBTREE_ESTIMATOR_H
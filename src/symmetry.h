@@ -0,0 +1,115 @@
+#include <array>
+#include <string>
+#include <vector>
+
+#include "array_map.h"
+#include "bit_map.h"
+#include "map_info.h"
+
+#ifndef MI_PDP_SYMMETRY_H
+#define MI_PDP_SYMMETRY_H
+
+using namespace std;
+
+// Mirrors and rotations of the board that map the banned cells onto themselves. Tiles fit and
+// pay the same in both orientations, so such a map turns every solution into another one of
+// the same price and the search needs only one of each orbit.
+//
+// The kept one is the lex leader -- read the shape() of cells in scan order, no image of the
+// solution may read higher. A board is cut as soon as some image reads higher on cells decided
+// in both, those are the cells before the cursor and the covered ones.
+class Symmetry {
+public:
+    Symmetry(const MapInfo *info) : rows(info->rows), columns(info->columns) {
+        // last argument is where the links right, down, left and up point in the image
+        add(info, "mirror x", [this](const int &x, const int &y) { return cell(columns - 1 - x, y); },
+            {LINK_LEFT, LINK_DOWN, LINK_RIGHT, LINK_UP});
+        add(info, "mirror y", [this](const int &x, const int &y) { return cell(x, rows - 1 - y); },
+            {LINK_RIGHT, LINK_UP, LINK_LEFT, LINK_DOWN});
+        add(info, "rotate 180", [this](const int &x, const int &y) { return cell(columns - 1 - x, rows - 1 - y); },
+            {LINK_LEFT, LINK_UP, LINK_RIGHT, LINK_DOWN});
+        if (rows != columns)
+            return;
+        add(info, "transpose", [this](const int &x, const int &y) { return cell(y, x); },
+            {LINK_DOWN, LINK_RIGHT, LINK_UP, LINK_LEFT});
+        add(info, "anti-transpose", [this](const int &x, const int &y) { return cell(columns - 1 - y, rows - 1 - x); },
+            {LINK_UP, LINK_LEFT, LINK_DOWN, LINK_RIGHT});
+        add(info, "rotate 90", [this](const int &x, const int &y) { return cell(columns - 1 - y, x); },
+            {LINK_DOWN, LINK_LEFT, LINK_UP, LINK_RIGHT});
+        add(info, "rotate 270", [this](const int &x, const int &y) { return cell(y, rows - 1 - x); },
+            {LINK_UP, LINK_RIGHT, LINK_DOWN, LINK_LEFT});
+    }
+
+    bool empty() const {
+        return transforms.empty();
+    }
+
+    const vector<string> &names() const {
+        return transformNames;
+    }
+
+    // false when some image of every solution below this board reads higher
+    template<class Board>
+    bool leader(const Board &map) const {
+        int cursor = cell(map.x, map.y);
+        for (const Transform &transform : transforms) {
+            for (int c = 0; c < rows * columns; c++) {
+                int s = transform.source[(size_t) c];
+                int shape = map.shape(c % columns, c / columns);
+                int imageShape = map.shape(s % columns, s / columns);
+                // free cells from the cursor on may still get covered
+                if ((shape == 0 && c >= cursor) || (imageShape == 0 && s >= cursor))
+                    break;
+                imageShape = transform.shapes[imageShape];
+                if (shape != imageShape) {
+                    if (imageShape > shape)
+                        return false;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Transform {
+        vector<int> source; // cell of the board the image shows at each cell
+        int shapes[2 * CELL_COVERED]; // shape of a cell as it looks in the image
+    };
+
+    int rows, columns;
+    vector<Transform> transforms;
+    vector<string> transformNames;
+
+    int cell(const int &x, const int &y) const {
+        return y * columns + x;
+    }
+
+    template<class Mapping>
+    void add(const MapInfo *info, const string &name, const Mapping &mapping, const array<int, 4> &links) {
+        for (const auto &ban : info->banned) {
+            int image = mapping(ban.first, ban.second);
+            if (!info->isBanned(image % columns, image / columns))
+                return;
+        }
+
+        Transform transform;
+        transform.source.resize((size_t) (rows * columns));
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < columns; x++)
+                transform.source[(size_t) mapping(x, y)] = cell(x, y);
+        }
+        // link bits go right, down, left, up from the lowest
+        for (int shape = 0; shape < 2 * CELL_COVERED; shape++) {
+            transform.shapes[shape] = shape & CELL_COVERED;
+            for (int link = 0; link < 4; link++) {
+                if (shape & (1 << link))
+                    transform.shapes[shape] |= links[(size_t) link];
+            }
+        }
+        transforms.push_back(transform);
+        transformNames.push_back(name);
+    }
+};
+
+#endif //MI_PDP_SYMMETRY_H
@@ -0,0 +1,39 @@
+#include <algorithm>
+
+#include "map_info.h"
+
+#ifndef MI_PDP_TILE_KERNEL_H
+#define MI_PDP_TILE_KERNEL_H
+
+using namespace std;
+
+// Tile lengths of the in place search, fixed when it is compiled or read from MapInfo.
+// With both fixed every fit test, placement and dead cell scan loops a known number of times
+// and unrolls. TileKernel<0, 0> is the generic search for any lengths
+template<int I1, int I2>
+struct TileKernel {
+    enum {
+        SHORTEST = I1 < I2 ? I1 : I2
+    };
+
+    // this search was compiled for the tiles of the instance
+    static bool matches(const MapInfo &info) {
+        return info.i1 == I1 && info.i2 == I2;
+    }
+
+    static int first(const MapInfo &info) {
+        return I1 > 0 ? I1 : info.i1;
+    }
+
+    static int second(const MapInfo &info) {
+        return I2 > 0 ? I2 : info.i2;
+    }
+
+    static int shortest(const MapInfo &info) {
+        return SHORTEST > 0 ? SHORTEST : min(info.i1, info.i2);
+    }
+};
+
+typedef TileKernel<0, 0> GenericKernel;
+
+#endif //MI_PDP_TILE_KERNEL_H
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bit_map.h"
+
+#ifndef MI_PDP_TRANSPOSITION_TABLE_H
+#define MI_PDP_TRANSPOSITION_TABLE_H
+
+using namespace std;
+
+// Best price seen for a search frontier. Search goes in row-major order, so what is left to
+// decide depends only on the cursor and the occupancy of the rows a vertical tile can reach
+// from it. Reaching the same frontier again with no better price cannot improve the result.
+//
+// Fixed size, one slot per key, newest wins. Slots are written without locks, a slot keeps
+// key ^ data next to data so a slot torn by two threads fails the key check.
+class TranspositionTable {
+public:
+    TranspositionTable(const int &sizeLog2, const int &rows, const int &columns, const int &depthRows)
+            : mask((1ULL << sizeLog2) - 1), entries(new Entry[1ULL << sizeLog2]),
+              columns(columns), depthRows(depthRows), rowBytes((columns + 7) / 8) {
+        for (uint64_t i = 0; i <= mask; i++) {
+            entries[i].check.store(0, memory_order_relaxed);
+            entries[i].data.store(0, memory_order_relaxed);
+        }
+
+        // Zobrist keys -- one per cursor position, one per byte value of every frontier row byte
+        mt19937_64 random(20181);
+        cursorKeys.resize((size_t) (rows * columns));
+        for (uint64_t &key : cursorKeys)
+            key = random();
+        rowKeys.resize((size_t) (depthRows * rowBytes * 256));
+        for (uint64_t &key : rowKeys)
+            key = random();
+    }
+
+    uint64_t key(const BitMap &map) const {
+        uint64_t hash = cursorKeys[(size_t) (map.y * columns + map.x)];
+        int last = min(map.rows, map.y + depthRows);
+        for (int iy = map.y; iy < last; iy++) {
+            uint64_t row = map.getRow(iy);
+            // cells before the cursor are decided already
+            if (iy == map.y)
+                row &= ~0ULL << map.x;
+
+            const uint64_t *keys = &rowKeys[(size_t) ((iy - map.y) * rowBytes * 256)];
+            for (int b = 0; b < rowBytes; b++, row >>= 8)
+                hash ^= keys[b * 256 + (int) (row & 0xff)];
+        }
+        return hash;
+    }
+
+    // true when the frontier was reached before with price at least as good,
+    // otherwise remembers this price for it
+    bool dominated(const uint64_t &key, const int &price) {
+        Entry &entry = entries[key & mask];
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        uint64_t check = entry.check.load(memory_order_relaxed);
+        if ((check ^ data) == key && (data & VALID)) {
+            if ((int) (int32_t) (uint32_t) data >= price)
+                return true;
+        }
+
+        data = VALID | (uint32_t) price;
+        entry.data.store(data, memory_order_relaxed);
+        entry.check.store(key ^ data, memory_order_relaxed);
+        return false;
+    }
+
+private:
+    struct Entry {
+        atomic<uint64_t> check;
+        atomic<uint64_t> data; // VALID | price
+    };
+
+    static const uint64_t VALID = 1ULL << 32;
+
+    uint64_t mask;
+    unique_ptr<Entry[]> entries;
+    int columns;
+    int depthRows;
+    int rowBytes;
+    vector<uint64_t> cursorKeys;
+    vector<uint64_t> rowKeys;
+};
+
+#endif //MI_PDP_TRANSPOSITION_TABLE_H